@@ -16,27 +16,28 @@
 /* project libraries */
 #include "src/config.h"
 #include "src/def.h"
+#include "src/rng.h"
+#include "src/rt.h"
 #include "src/scheduler.h"
 #include "src/task.h"
 #include "src/timelib.h"
+#include "src/trace.h"
 
 #include "src/robot.h"
 #include "src/doublylinkedlist.h"
 
-// 100 ms of minor cycle
-#define SCHEDULER_MINOR_CYCLE       100
-
-// Pointer to the scheduler structure, we want to be able to
-// free the allocated resources (destroy the scheduler) even
-// from the signal handler outside of the main function
+// Pointer to the scheduler structure
 static scheduler_t *ces;
+// A stop was requested with Ctrl-C
+static volatile sig_atomic_t stop_requested = 0;
 
 /* -- Functions -- */
 /*
  * Function:	    sig_handler
  * Brief:	        The signal handler function to use when aborting our program with Ctrl-C.
- *                  Its main purpose is to be able to get some statistics from the scheduler
- *                  even if the program was interrupted (if a SIGINT signal was sent via Ctrl-C).
+ *                  It only asks the scheduler to stop; main() then dumps the statistics
+ *                  and frees the tasks once no task runs any more. A second Ctrl-C ends
+ *                  the program at once (a task stuck in I/O).
  * @param signo:	The signal to catch
  * Returns:	        Shall return 0 for the moment
 */
@@ -59,21 +60,42 @@ int main()
     // Initialization
     // Load Configuration
     config_load();
+    // Seed the random number streams (the same seed replays the same run)
+    rng_init(g_config.sim_seed);
+    // Simulation: virtual clock and a fixed seed make every run the same
+    if (g_config.sim_enable)
+    {
+        printf("Simulation on the virtual clock (seed %u, %d s)\n", g_config.sim_seed, g_config.sim_duration);
+        timelib_clock_init(s_TIMELIB_CLOCK_VIRTUAL);
+    }
+    // Init tracer (the trace is written at exit, also after Ctrl-C)
+    trace_init(g_config.trace_enable ? g_config.trace_events : 0);
+    // Real-time hardening, before the tasks allocate their data
+    if (g_config.rt_enable)
+    {
+        rt_init(g_config.rt_cpu, g_config.rt_priority);
+    }
     // Init tasks
     task_init(1);
-    // Init scheduler (Set minor and mayor cycle)
-    ces = scheduler_init(SCHEDULER_MINOR_CYCLE);
+    // Init scheduler (Set minor cycle, build frames from the task table)
+    ces = scheduler_init(g_config.scheduler_minor_cycle);
+    if (ces == NULL)
+    {
+        // Infeasible task table, nothing to run
+        task_destroy();
+        return 1;
+    }
 
     // Run scheduler
     scheduler_run(ces);
 
-    // Before end application deinitialize and free memory
-    // Deinit tasks
-    task_destroy();
-    // Deinit scheduler
+    // The scheduler returned (end of simulation or Ctrl-C), no task runs now
     // Dump some nice stats
     scheduler_dump_statistics(ces);
 
+    // Before end application deinitialize and free memory
+    // Deinit tasks
+    task_destroy();
     // Destroy scheduler
     scheduler_destroy(ces);
 
@@ -86,19 +108,23 @@ int main()
 
 int sig_handler(int signo)
 {
+    static const char msg[] = "SIGINT received!\n";
+
     if (signo == SIGINT)
     {
-        fprintf(stderr, "SIGINT received!\n");
-        // Dump stats
-        scheduler_dump_statistics(ces);
-        // Deinit tasks
-        task_destroy();
-        // Destroy scheduler
-        scheduler_destroy(ces);
-        // And say goodbye! 
-        printf("Goodbye from signal handler!\n");
-        // Exit our program
-        exit(SIGINT);
+        // Second Ctrl-C, do not wait any longer
+        if (stop_requested)
+        {
+            _exit(SIGINT);
+        }
+        stop_requested = 1;
+        if (write(STDERR_FILENO, msg, sizeof(msg) - 1) < 0)
+        {
+            // Nothing to do, the message is only informative
+        }
+        // The tasks may still be running, main() cleans up after the scheduler returns
+        scheduler_stop();
+        return 0;
     }
     exit(signo);
 }
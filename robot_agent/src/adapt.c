@@ -0,0 +1,227 @@
+/**
+ * @file	adapt.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Adaptive workload controller library. The scheduler reports the CPU time
+ * the tasks used in every minor cycle. Once per control period the load
+ * (CPU time over elapsed time) is compared with the target load and a
+ * quality level between 0 and s_ADAPT_LEVEL_MAX is moved:
+ *
+ *  - load below the target: the level rises with the spare load (at most
+ *    s_ADAPT_STEP_UP per period)
+ *  - load above the target: the level falls with the excess load
+ *  - a minor cycle used up entirely: the level is halved at once
+ *
+ * The level scales the expensive work between the configured bounds: the
+ * number of particles, the stride of the pheromone smell evaluation and the
+ * number of pheromone map sectors broadcast per extraction. At the full
+ * level the configured workload runs unchanged.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+/* project libraries */
+#include "adapt.h"
+#include "histogram.h"
+
+/* -- Global Variables -- */
+static int adapt_enabled = s_FALSE; // Controller is running
+static int adapt_target = 0; // Target load (percent)
+static long long adapt_period = 0; // Control period (us)
+static int adapt_particles_min = 0; // Particles at level 0
+static int adapt_particles_max = 0; // Particles at the full level
+static int adapt_eval_step_max = 1; // Smell evaluation stride at level 0
+static int adapt_sectors_min = 0; // Sectors per extraction at level 0
+static int adapt_level = s_ADAPT_LEVEL_MAX; // Current quality level
+static int adapt_level_min = s_ADAPT_LEVEL_MAX; // Lowest level reached
+static long long adapt_busy = 0; // CPU time in the current control period (us)
+static long long adapt_elapsed = 0; // Time of the current control period (us)
+static int adapt_saturated = s_FALSE; // A minor cycle of the current period had no idle time
+static cnt_t adapt_saturations = 0; // Control periods with a saturated minor cycle
+static cnt_t adapt_changes = 0; // Control periods that changed the level
+static histogram_t adapt_load; // Load of every control period (percent)
+static histogram_t adapt_levels; // Level after every control period
+
+/* -- Functions -- */
+
+/**
+ * Initialize controller, it starts at full quality
+ * @param target Target load (percent of the CPU)
+ * @param period Control period (ms)
+ * @param particles_min Number of particles at level 0
+ * @param particles_max Number of particles at the full level (configured number)
+ * @param eval_step_max Stride of the smell evaluation at level 0
+ * @param sectors_min Number of sectors sent per extraction at level 0
+ * @return s_OK, s_ERROR if the bounds are invalid
+ */
+int adapt_init(	int target,
+				int period,
+				int particles_min,
+				int particles_max,
+				int eval_step_max,
+				int sectors_min)
+{
+	if(target <= 0 || target > 100 || period <= 0 || particles_min < 1
+		|| particles_min > particles_max || eval_step_max < 1 || sectors_min < 1)
+	{
+		fprintf(stderr, "adapt: invalid controller bounds, check config.ini\n");
+		return s_ERROR;
+	}
+
+	adapt_target = target;
+	adapt_period = (long long)period * 1000;
+	adapt_particles_min = particles_min;
+	adapt_particles_max = particles_max;
+	adapt_eval_step_max = eval_step_max;
+	adapt_sectors_min = sectors_min;
+	adapt_level = s_ADAPT_LEVEL_MAX;
+	adapt_level_min = s_ADAPT_LEVEL_MAX;
+	histogram_reset(&adapt_load);
+	histogram_reset(&adapt_levels);
+	adapt_enabled = s_TRUE;
+
+	printf("Adapt: target load %d %%, %d .. %d particles, smell stride %d .. 1, at least %d sectors\n",
+		adapt_target, adapt_particles_min, adapt_particles_max, adapt_eval_step_max, adapt_sectors_min);
+
+	return s_OK;
+}
+
+/**
+ * Account the CPU time of one minor cycle. At the end of every control period
+ * the level is moved toward the target load
+ * @param busy_us CPU time of the tasks in the minor cycle (us)
+ * @param cycle_us Length of the minor cycle (us)
+ * @return Void
+ */
+void adapt_cycle(long long busy_us, long long cycle_us)
+{
+	int load, level;
+
+	if(!adapt_enabled)
+		return;
+
+	adapt_busy += busy_us;
+	adapt_elapsed += cycle_us;
+	if(busy_us >= cycle_us)
+		adapt_saturated = s_TRUE;
+	if(adapt_elapsed < adapt_period)
+		return;
+
+	load = (int)(adapt_busy * 100 / adapt_elapsed);
+	histogram_record(&adapt_load, (unsigned long long)load);
+
+	if(adapt_saturated)
+	{
+		// Back off quickly, the next cycles are already late
+		level = adapt_level / 2;
+		adapt_saturations++;
+	}
+	else if(load > adapt_target)
+	{
+		level = adapt_level - s_ADAPT_GAIN * (load - adapt_target);
+	}
+	else
+	{
+		level = adapt_level + s_ADAPT_GAIN * (adapt_target - load);
+		if(level > adapt_level + s_ADAPT_STEP_UP)
+			level = adapt_level + s_ADAPT_STEP_UP;
+	}
+	if(level < 0)
+		level = 0;
+	if(level > s_ADAPT_LEVEL_MAX)
+		level = s_ADAPT_LEVEL_MAX;
+
+	if(level != adapt_level)
+		adapt_changes++;
+	adapt_level = level;
+	if(adapt_level < adapt_level_min)
+		adapt_level_min = adapt_level;
+	histogram_record(&adapt_levels, (unsigned long long)adapt_level);
+
+	adapt_busy = 0;
+	adapt_elapsed = 0;
+	adapt_saturated = s_FALSE;
+}
+
+/**
+ * Scale a knob linearly with the level
+ * @param low Value at level 0
+ * @param high Value at the full level
+ * @return Value at the current level
+ */
+static int adapt_scale(int low, int high)
+{
+	return (int)(((long long)low * (s_ADAPT_LEVEL_MAX - adapt_level) + (long long)high * adapt_level
+		+ s_ADAPT_LEVEL_MAX / 2) / s_ADAPT_LEVEL_MAX);
+}
+
+/**
+ * Check if the controller is running
+ * @return s_TRUE if it is initialized with valid bounds, s_FALSE otherwise
+ */
+int adapt_running(void)
+{
+	return adapt_enabled;
+}
+
+/**
+ * Get number of particles to use, valid only while the controller is running
+ * (otherwise the configured number stays in place)
+ * @return Number of particles
+ */
+int adapt_particles(void)
+{
+	return adapt_scale(adapt_particles_min, adapt_particles_max);
+}
+
+/**
+ * Get stride of the pheromone smell evaluation
+ * @return Stride in stencil cells (1 - every cell)
+ */
+int adapt_eval_step(void)
+{
+	if(!adapt_enabled)
+		return 1;
+
+	return adapt_scale(adapt_eval_step_max, 1);
+}
+
+/**
+ * Get number of pheromone map sectors to send per extraction
+ * @param sector_count Number of sectors of the map
+ * @return Number of sectors (all if the controller is off)
+ */
+int adapt_sectors(int sector_count)
+{
+	if(!adapt_enabled || adapt_sectors_min >= sector_count)
+		return sector_count;
+
+	return adapt_scale(adapt_sectors_min, sector_count);
+}
+
+/**
+ * Print controller statistics
+ * @return Void
+ */
+void adapt_dump_statistics(void)
+{
+	if(!adapt_enabled)
+		return;
+
+	printf("Adaptive workload:\t\tload %% p50 %llu, max %llu (target %d), level now %d, mean %.0f, min %d of %d, %llu changes, %llu saturated\n",
+		histogram_percentile(&adapt_load, 50),
+		adapt_load.max,
+		adapt_target,
+		adapt_level,
+		histogram_mean(&adapt_levels),
+		adapt_level_min,
+		s_ADAPT_LEVEL_MAX,
+		adapt_changes,
+		adapt_saturations);
+	printf("Adaptive workload knobs:\t%d particles, smell stride %d\n",
+		adapt_particles(), adapt_eval_step());
+}
@@ -0,0 +1,37 @@
+/**
+ * @file	adapt.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Adaptive workload controller library header file.
+ */
+
+#ifndef __ADAPT_H
+#define __ADAPT_H
+
+/* -- Includes -- */
+/* project libraries */
+#include "def.h"
+
+/* -- Constants -- */
+#define s_ADAPT_LEVEL_MAX				1000 // Quality level of the configured (full) workload, 0 is the cheapest
+#define s_ADAPT_GAIN					10 // Level change per percent of load error and control period
+#define s_ADAPT_STEP_UP					100 // Largest level increase per control period
+
+/* -- Function Prototypes -- */
+int adapt_init(	int target,
+				int period,
+				int particles_min,
+				int particles_max,
+				int eval_step_max,
+				int sectors_min); // Start at full quality
+void adapt_cycle(long long busy_us, long long cycle_us); // Account the CPU time of one minor cycle, adjust the level once per control period
+int adapt_running(void); // Controller is initialized and adapting
+int adapt_particles(void); // Number of particles to use (only while running)
+int adapt_eval_step(void); // Stride of the pheromone smell evaluation (1 - every cell)
+int adapt_sectors(int sector_count); // Number of pheromone map sectors to send per extraction
+void adapt_dump_statistics(void); // Print controller statistics
+
+#endif /* __ADAPT_H */
@@ -0,0 +1,207 @@
+/**
+ * @file	clocksync.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * TDMA clock synchronisation library. Mission control stamps every GO_AHEAD
+ * with its clock (milliseconds within the minute). Each stamp gives a sample
+ * of the offset between that clock and our monotonic clock; a second-order
+ * filter tracks offset and drift. The scheduler asks for the correction of
+ * each release and slews it towards the grid of mission control, so that the
+ * TDMA slots of all robots stay apart over long runs.
+ *
+ * A packet that waited before it was handled looks like a clock that went
+ * back. Such samples (more than s_CLOCKSYNC_GATE late) are dropped. A sample
+ * far ahead means that the earlier ones were delayed (the first packets wait
+ * in the socket while the robot starts up), the filter then starts over.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <math.h>
+/* project libraries */
+#include "clocksync.h"
+#include "timelib.h"
+
+/* -- Global Variables -- */
+static int clocksync_locked = s_FALSE; // At least one sample was taken
+static int clocksync_stepped = s_FALSE; // First correction (a step) was handed out
+static double clocksync_offset = 0; // Mission control minus local time at clocksync_last (ms)
+static double clocksync_drift = 0; // Rate of the offset (ms per ms)
+static double clocksync_last = 0; // Local time of the last accepted sample (ms)
+static cnt_t clocksync_samples = 0; // Accepted samples
+static cnt_t clocksync_rejected = 0; // Dropped (delayed) samples
+static cnt_t clocksync_relocks = 0; // Restarts from a sample far ahead of the estimate
+static double clocksync_error = 0; // Phase error of the last release (ms)
+static double clocksync_slewed = 0; // Sum of all corrections (ms)
+
+/* -- Functions -- */
+
+/**
+ * Local monotonic time in milliseconds
+ * @param ts Timespec structure
+ * @return Milliseconds
+ */
+static double clocksync_ms(const struct timespec *ts)
+{
+	return ts->tv_sec * 1000.0 + ts->tv_nsec / 1e6;
+}
+
+/**
+ * Wrap value into [-period / 2, period / 2)
+ * @param value Value
+ * @param period Period
+ * @return Wrapped value
+ */
+static double clocksync_wrap(double value, double period)
+{
+	value = fmod(value + period / 2, period);
+	if(value < 0)
+		value += period;
+
+	return value - period / 2;
+}
+
+/**
+ * Forget all samples
+ * @return Void
+ */
+void clocksync_init(void)
+{
+	clocksync_locked = s_FALSE;
+	clocksync_stepped = s_FALSE;
+	clocksync_offset = 0;
+	clocksync_drift = 0;
+	clocksync_samples = 0;
+	clocksync_rejected = 0;
+	clocksync_relocks = 0;
+	clocksync_error = 0;
+	clocksync_slewed = 0;
+}
+
+/**
+ * Add mission control time stamp of a packet received now
+ * @param send_time Time stamp (milliseconds within the minute)
+ * @return Void
+ */
+void clocksync_sample(int send_time)
+{
+	struct timespec ts_now;
+	double now, offset, dt, predicted, error;
+
+	timelib_clock_gettime(&ts_now);
+	now = clocksync_ms(&ts_now);
+	offset = clocksync_wrap(send_time - fmod(now, s_CLOCKSYNC_WRAP), s_CLOCKSYNC_WRAP);
+
+	if(clocksync_locked)
+	{
+		// Offset expected now and how far the sample is off
+		dt = now - clocksync_last;
+		predicted = clocksync_offset + clocksync_drift * dt;
+		error = clocksync_wrap(offset - predicted, s_CLOCKSYNC_WRAP);
+		if(error < -s_CLOCKSYNC_GATE)
+		{
+			clocksync_rejected++;
+			return;
+		}
+		if(error <= s_CLOCKSYNC_GATE)
+		{
+			clocksync_offset = predicted + s_CLOCKSYNC_GAIN_OFFSET * error;
+			if(dt > 0)
+			{
+				clocksync_drift += s_CLOCKSYNC_GAIN_DRIFT * error / dt;
+				if(clocksync_drift > s_CLOCKSYNC_DRIFT_MAX)
+					clocksync_drift = s_CLOCKSYNC_DRIFT_MAX;
+				else if(clocksync_drift < -s_CLOCKSYNC_DRIFT_MAX)
+					clocksync_drift = -s_CLOCKSYNC_DRIFT_MAX;
+			}
+			clocksync_last = now;
+			clocksync_samples++;
+			return;
+		}
+		// Far ahead of the estimate: the samples so far were delayed (or
+		// mission control set its clock), start over from this one
+		clocksync_relocks++;
+	}
+
+	clocksync_offset = offset;
+	clocksync_drift = 0;
+	clocksync_last = now;
+	clocksync_locked = s_TRUE;
+	clocksync_stepped = s_FALSE;
+	clocksync_samples++;
+}
+
+/**
+ * Get correction of a release, so that it falls at the given position of a
+ * period of mission control time. The first correction after the first sample
+ * (or after a restart) is a step, later ones are limited to s_CLOCKSYNC_SLEW
+ * @param release Release instant (local monotonic time)
+ * @param position Position within the period (ms)
+ * @param period Period (ms)
+ * @return Correction to add to the release (us), 0 before the first sample
+ */
+long long clocksync_correction_us(const struct timespec *release, unsigned int position, unsigned int period)
+{
+	double local, remote, correction;
+
+	if(!clocksync_locked || period == 0)
+		return 0;
+
+	// Mission control time at the release, and how late that is
+	local = clocksync_ms(release);
+	remote = local + clocksync_offset + clocksync_drift * (local - clocksync_last);
+	clocksync_error = clocksync_wrap(remote - position, period);
+
+	correction = -clocksync_error;
+	if(clocksync_stepped)
+	{
+		if(correction > s_CLOCKSYNC_SLEW / 1000.0)
+			correction = s_CLOCKSYNC_SLEW / 1000.0;
+		else if(correction < -s_CLOCKSYNC_SLEW / 1000.0)
+			correction = -s_CLOCKSYNC_SLEW / 1000.0;
+	}
+	clocksync_stepped = s_TRUE;
+	clocksync_slewed += correction;
+
+	return (long long)llround(correction * 1000.0);
+}
+
+/**
+ * Get offset of mission control to our wall clock
+ * @return Mission control minus wall-clock time (ms), 0 before the first sample
+ */
+double clocksync_offset_ms(void)
+{
+	struct timespec ts_now;
+	double now, remote;
+
+	if(!clocksync_locked)
+		return 0;
+
+	timelib_clock_gettime(&ts_now);
+	now = clocksync_ms(&ts_now);
+	remote = now + clocksync_offset + clocksync_drift * (now - clocksync_last);
+
+	return clocksync_wrap(remote - (double)(timelib_wall_now() % (s_CLOCKSYNC_WRAP * s_TIMELIB_NS_PER_MS)) / s_TIMELIB_NS_PER_MS, s_CLOCKSYNC_WRAP);
+}
+
+/**
+ * Print offset of mission control to our wall clock, drift and corrections
+ * @return Void
+ */
+void clocksync_dump_statistics(void)
+{
+	if(!clocksync_locked)
+	{
+		printf("TDMA clock sync:\t\tno GO_AHEAD time stamps received\n");
+		return;
+	}
+
+	// Offset to our wall clock, which the scheduler started aligned to
+	printf("TDMA clock sync:\t\toffset %.2f ms, drift %.1f ppm, release error %.2f ms, corrected %.2f ms (%llu samples, %llu delayed, %llu restarts)\n",
+		clocksync_offset_ms(), clocksync_drift * 1e6, clocksync_error, clocksync_slewed, clocksync_samples, clocksync_rejected, clocksync_relocks);
+}
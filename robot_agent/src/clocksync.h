@@ -0,0 +1,35 @@
+/**
+ * @file	clocksync.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * TDMA clock synchronisation library header file.
+ */
+
+#ifndef __CLOCKSYNC_H
+#define __CLOCKSYNC_H
+
+/* -- Includes -- */
+/* system libraries */
+#include <time.h>
+/* project libraries */
+#include "def.h"
+
+/* -- Constants -- */
+#define s_CLOCKSYNC_WRAP				60000 // Mission control time stamps wrap every minute (ms)
+#define s_CLOCKSYNC_GAIN_OFFSET			0.25 // Part of the offset error corrected per sample
+#define s_CLOCKSYNC_GAIN_DRIFT			0.05 // Part of the offset error taken as drift per sample
+#define s_CLOCKSYNC_DRIFT_MAX			500e-6 // Largest drift believed (500 ppm)
+#define s_CLOCKSYNC_GATE				20 // Samples this much older than expected were delayed, not a clock change (ms)
+#define s_CLOCKSYNC_SLEW				500 // Largest correction of one release once synchronised (us)
+
+/* -- Function Prototypes -- */
+void clocksync_init(void); // Forget all samples
+void clocksync_sample(int send_time); // Add mission control time stamp of a received packet
+long long clocksync_correction_us(const struct timespec *release, unsigned int position, unsigned int period); // Get correction of a release
+double clocksync_offset_ms(void); // Get offset of mission control to our wall clock
+void clocksync_dump_statistics(void); // Print offset (to the wall clock) and drift
+
+#endif /* __CLOCKSYNC_H */
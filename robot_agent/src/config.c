@@ -21,18 +21,51 @@
 /* -- Global Variables -- */
 config_t g_config;
 
+// Ini section names of the task table, indexed by task ID (see task.h)
+static const char *config_task_sections[s_CONFIG_TASK_NUM + 1] =
+{
+	NULL,
+	"task_mission",
+	"task_navigate",
+	"task_control",
+	"task_refine",
+	"task_report",
+	"task_communicate",
+	"task_avoid"
+};
+
+// Default task table, indexed by task ID
+static const config_task_t config_task_defaults[s_CONFIG_TASK_NUM + 1] =
+{
+	{ 0, 0, 0, 0, s_CONFIG_CRITICALITY_LOW },
+	s_CONFIG_DEFAULT_TASK_MISSION,
+	s_CONFIG_DEFAULT_TASK_NAVIGATE,
+	s_CONFIG_DEFAULT_TASK_CONTROL,
+	s_CONFIG_DEFAULT_TASK_REFINE,
+	s_CONFIG_DEFAULT_TASK_REPORT,
+	s_CONFIG_DEFAULT_TASK_COMMUNICATE,
+	s_CONFIG_DEFAULT_TASK_AVOID
+};
+
 /* -- Functions -- */
 
 void config_load(void)
+{
+	config_load_file("./res/config.ini");
+}
+
+void config_load_file(const char *path)
 {
 	// Local variables
 	dictionary *ini;
 	char *s;
+	char key[64];
+	int i;
 	
-	ini = iniparser_load("./res/config.ini");
+	ini = iniparser_load(path);
 	if (ini == NULL) {
-        fprintf(stderr, "cannot parse file");
-        return -1 ;
+        fprintf(stderr, "cannot parse file %s\n", path);
+        return;
     }
     //iniparser_dump(ini, stderr);
 	
@@ -56,6 +89,7 @@ void config_load(void)
 	g_config.pf_noise_turn = iniparser_getint(ini, "pf:noise_turn", s_CONFIG_DEFAULT_PF_NOISE_TURN);
 	g_config.pf_noise_tag = iniparser_getint(ini, "pf:noise_tag", s_CONFIG_DEFAULT_PF_NOISE_TAG);
 	g_config.pf_noise_wall = iniparser_getint(ini, "pf:noise_wall", s_CONFIG_DEFAULT_PF_NOISE_WALL);
+	g_config.pf_simd = iniparser_getboolean(ini, "pf:simd", s_CONFIG_DEFAULT_PF_SIMD);
 
 	// -- Robot --
 	g_config.robot_id = iniparser_getint(ini, "robot:id", s_CONFIG_DEFAULT_ROBOT_ID);
@@ -84,8 +118,81 @@ void config_load(void)
 	g_config.network_bitrate = iniparser_getint(ini, "network:bitrate", s_CONFIG_DEFAULT_NETWORK_BITRATE);
 	g_config.network_tdma_slot_num = iniparser_getint(ini, "network:tdma_slot_num", s_CONFIG_DEFAULT_NETWORK_TDMA_SLOT_NUM);
 	g_config.network_tdma_period = iniparser_getint(ini, "network:tdma_period", s_CONFIG_DEFAULT_NETWORK_TDMA_PERIOD);
-
-
+	g_config.network_tdma_sync = iniparser_getboolean(ini, "network:tdma_sync", s_CONFIG_DEFAULT_NETWORK_TDMA_SYNC);
+	g_config.network_tdma_dynamic = iniparser_getboolean(ini, "network:tdma_dynamic", s_CONFIG_DEFAULT_NETWORK_TDMA_DYNAMIC);
+
+	// -- Scheduler --
+	g_config.scheduler_minor_cycle = iniparser_getint(ini, "scheduler:minor_cycle", s_CONFIG_DEFAULT_SCHEDULER_MINOR_CYCLE);
+	s = iniparser_getstring(ini, "scheduler:executor", s_CONFIG_DEFAULT_SCHEDULER_EXECUTOR);
+	g_config.scheduler_executor = (strcmp(s, "fifo") == 0) ? s_CONFIG_EXECUTOR_FIFO : s_CONFIG_EXECUTOR_CYCLIC;
+	s = iniparser_getstring(ini, "scheduler:priority", s_CONFIG_DEFAULT_SCHEDULER_PRIORITY);
+	g_config.scheduler_priority = (strcmp(s, "rm") == 0) ? s_CONFIG_PRIORITY_RM : s_CONFIG_PRIORITY_DM;
+	g_config.scheduler_event_loop = iniparser_getboolean(ini, "scheduler:event_loop", s_CONFIG_DEFAULT_SCHEDULER_EVENT_LOOP);
+	g_config.scheduler_watchdog = iniparser_getboolean(ini, "scheduler:watchdog", s_CONFIG_DEFAULT_SCHEDULER_WATCHDOG);
+
+	// -- Task table --
+	g_config.tasks[0] = config_task_defaults[0];
+	for(i = 1; i <= s_CONFIG_TASK_NUM; i++)
+	{
+		sprintf(key, "%s:period", config_task_sections[i]);
+		g_config.tasks[i].period = iniparser_getint(ini, key, config_task_defaults[i].period);
+		sprintf(key, "%s:phase", config_task_sections[i]);
+		g_config.tasks[i].phase = iniparser_getint(ini, key, config_task_defaults[i].phase);
+		// Deadline defaults to the period once the period has been retuned
+		sprintf(key, "%s:deadline", config_task_sections[i]);
+		g_config.tasks[i].deadline = iniparser_getint(ini, key,
+			(g_config.tasks[i].period == config_task_defaults[i].period) ? config_task_defaults[i].deadline : g_config.tasks[i].period);
+		sprintf(key, "%s:wcet", config_task_sections[i]);
+		g_config.tasks[i].wcet = iniparser_getint(ini, key, config_task_defaults[i].wcet);
+		sprintf(key, "%s:criticality", config_task_sections[i]);
+		s = iniparser_getstring(ini, key, NULL);
+		if(s == NULL)
+			g_config.tasks[i].criticality = config_task_defaults[i].criticality;
+		else
+			g_config.tasks[i].criticality = (strcmp(s, "high") == 0) ? s_CONFIG_CRITICALITY_HIGH : s_CONFIG_CRITICALITY_LOW;
+	}
+
+	// -- Overload manager --
+	g_config.overload_enable = iniparser_getboolean(ini, "overload:enable", s_CONFIG_DEFAULT_OVERLOAD_ENABLE);
+	g_config.overload_trigger = iniparser_getint(ini, "overload:trigger", s_CONFIG_DEFAULT_OVERLOAD_TRIGGER);
+	g_config.overload_recover = iniparser_getint(ini, "overload:recover", s_CONFIG_DEFAULT_OVERLOAD_RECOVER);
+	g_config.overload_slack = iniparser_getint(ini, "overload:slack", s_CONFIG_DEFAULT_OVERLOAD_SLACK);
+
+	// -- Adaptive workload controller --
+	g_config.adapt_enable = iniparser_getboolean(ini, "adapt:enable", s_CONFIG_DEFAULT_ADAPT_ENABLE);
+	g_config.adapt_target = iniparser_getint(ini, "adapt:target", s_CONFIG_DEFAULT_ADAPT_TARGET);
+	g_config.adapt_period = iniparser_getint(ini, "adapt:period", s_CONFIG_DEFAULT_ADAPT_PERIOD);
+	g_config.adapt_particles_min = iniparser_getint(ini, "adapt:particles_min", s_CONFIG_DEFAULT_ADAPT_PARTICLES_MIN);
+	g_config.adapt_eval_step_max = iniparser_getint(ini, "adapt:eval_step_max", s_CONFIG_DEFAULT_ADAPT_EVAL_STEP_MAX);
+	g_config.adapt_sectors_min = iniparser_getint(ini, "adapt:sectors_min", s_CONFIG_DEFAULT_ADAPT_SECTORS_MIN);
+
+	// -- Reader threads --
+	g_config.reader_enable = iniparser_getboolean(ini, "reader:enable", s_CONFIG_DEFAULT_READER_ENABLE);
+	g_config.reader_oi_period = iniparser_getint(ini, "reader:oi_period", s_CONFIG_DEFAULT_READER_OI_PERIOD);
+
+	// -- Trace --
+	g_config.trace_enable = iniparser_getboolean(ini, "trace:enable", s_CONFIG_DEFAULT_TRACE_ENABLE);
+	g_config.trace_events = iniparser_getint(ini, "trace:events", s_CONFIG_DEFAULT_TRACE_EVENTS);
+	s = iniparser_getstring(ini, "trace:path", s_CONFIG_DEFAULT_TRACE_PATH);
+	strcpy(g_config.trace_path, s);
+
+	// -- Real-time hardening --
+	g_config.rt_enable = iniparser_getboolean(ini, "rt:enable", s_CONFIG_DEFAULT_RT_ENABLE);
+	g_config.rt_cpu = iniparser_getint(ini, "rt:cpu", s_CONFIG_DEFAULT_RT_CPU);
+	g_config.rt_priority = iniparser_getint(ini, "rt:priority", s_CONFIG_DEFAULT_RT_PRIORITY);
+
+	// -- Simulation --
+	g_config.sim_enable = iniparser_getboolean(ini, "sim:enable", s_CONFIG_DEFAULT_SIM_ENABLE);
+	g_config.sim_seed = (unsigned int)iniparser_getint(ini, "sim:seed", s_CONFIG_DEFAULT_SIM_SEED);
+	g_config.sim_duration = iniparser_getint(ini, "sim:duration", s_CONFIG_DEFAULT_SIM_DURATION);
+	// The virtual clock has a single sleeper and input must not depend on the
+	// host speed: one thread runs everything, devices are read by the tasks
+	if(g_config.sim_enable)
+	{
+		g_config.scheduler_executor = s_CONFIG_EXECUTOR_CYCLIC;
+		g_config.scheduler_event_loop = 0;
+		g_config.reader_enable = 0;
+	}
 
 	/*// -- Scenario --
 	int scenario_victims_max;
@@ -17,8 +17,34 @@
 /* project libraries */
 
 
+/* -- Constants -- */
+
+/* TASKS */
+#define s_CONFIG_TASK_NUM					7 // Number of tasks (IDs 1 .. 7, see task.h)
+#define s_CONFIG_TASK_PHASE_TDMA			-1 // Phase placeholder: TDMA slot of this robot
+#define s_CONFIG_CRITICALITY_LOW			0
+#define s_CONFIG_CRITICALITY_HIGH			1
+#define s_CONFIG_EXECUTOR_CYCLIC			0 // Cyclic executive (frames)
+#define s_CONFIG_EXECUTOR_FIFO				1 // One SCHED_FIFO thread per task
+#define s_CONFIG_PRIORITY_RM				0 // Rate-monotonic priorities
+#define s_CONFIG_PRIORITY_DM				1 // Deadline-monotonic priorities
+
+
 /* -- Types -- */
 
+/**
+ * @brief Task table entry (scheduling parameters of one task)
+ */
+typedef struct s_CONFIG_TASK_STRUCT
+{
+	int period; // Period in milliseconds (0 - task is not scheduled)
+	int phase; // Phase offset within the period in milliseconds (-1 - TDMA slot of this robot)
+	int deadline; // Relative deadline in milliseconds
+	int wcet; // WCET budget in milliseconds
+	int criticality; // Criticality level (s_CONFIG_CRITICALITY_*)
+
+} config_task_t;
+
 
 /**
  * @brief Configuration structure
@@ -39,6 +65,7 @@ typedef struct s_CONFIG_STRUCT
 	int pf_noise_turn; // Error created during turning (degrees)
 	int pf_noise_tag; // Error of tag read (mm)
 	int pf_noise_wall; // Error of wall read (mm)
+	int pf_simd; // Use the vector kernels (AVX2 or SSE2, whatever the CPU has)
 
 	// robot
 	int robot_id;
@@ -70,7 +97,49 @@ typedef struct s_CONFIG_STRUCT
 	int network_bitrate; // Network bit-rate
 	int network_tdma_slot_num; // Number of slots in TDMA period
 	int network_tdma_period; // TDMA period length in milliseconds
-
+	int network_tdma_sync; // Slew the minor cycle releases to the clock of mission control (GO_AHEAD time stamps)
+	int network_tdma_dynamic; // Allocate the TDMA slot by rank among the robots heard (superframes if more robots than slots)
+
+	// scheduler
+	int scheduler_minor_cycle; // Minor cycle in milliseconds
+	int scheduler_executor; // s_CONFIG_EXECUTOR_CYCLIC or s_CONFIG_EXECUTOR_FIFO
+	int scheduler_priority; // Priority assignment of the FIFO executor (s_CONFIG_PRIORITY_RM or s_CONFIG_PRIORITY_DM)
+	int scheduler_event_loop; // Handle UDP and serial input in the idle time (epoll) while waiting for the next release
+	int scheduler_watchdog; // Enforce the WCET budgets of the task table with a watchdog thread
+	config_task_t tasks[s_CONFIG_TASK_NUM + 1]; // Task table, indexed by task ID (0 is NOP)
+
+	// overload manager
+	int overload_enable; // Degrade low-criticality tasks when high-criticality tasks overrun
+	int overload_trigger; // High-criticality overruns (without a job with slack in between) that degrade
+	int overload_recover; // Consecutive high-criticality jobs with slack that restore normal mode
+	int overload_slack; // Slack a job needs to count for recovery (percent of its deadline)
+
+	// adaptive workload controller
+	int adapt_enable; // Scale particles, smell evaluation and pheromone broadcast to hold the target load
+	int adapt_target; // Target CPU load of the tasks (percent)
+	int adapt_period; // Control period (ms)
+	int adapt_particles_min; // Fewest particles (pf particles_num is the most)
+	int adapt_eval_step_max; // Coarsest stride of the smell evaluation (stencil cells)
+	int adapt_sectors_min; // Fewest pheromone map sectors sent per extraction
+
+	// reader threads
+	int reader_enable; // Serve the serial devices from reader threads
+	int reader_oi_period; // Open Interface polling period of the reader thread (ms)
+
+	// trace
+	int trace_enable; // Record trace events
+	int trace_events; // Size of the trace ring buffer (events)
+	char trace_path[256]; // Chrome trace JSON written at exit
+
+	// real-time hardening
+	int rt_enable; // Lock memory, pin and prioritize the executive, prefault at startup
+	int rt_cpu; // Core the executive is pinned to (-1 - not pinned)
+	int rt_priority; // SCHED_FIFO priority of the executive (0 - not changed)
+
+	// simulation
+	int sim_enable; // Run on the virtual clock (no sleeping, repeatable for a given seed)
+	unsigned int sim_seed; // Seed of the random number generator
+	int sim_duration; // Simulated mission length in seconds (0 - until Ctrl-C)
 
 } config_t;
 
@@ -105,6 +174,10 @@ typedef struct s_CONFIG_STRUCT
 //#define s_CONFIG_TEST_ENABLE				1
 //#define s_CONFIG_DEBUG_ENABLE				1
 
+/* SCHEDULE */
+// Compile in the frame table generated by schedgen (src/schedule_table.h, see "make schedule")
+//#define s_CONFIG_SCHEDULE_TABLE_ENABLE		1
+
 
 
  /* DEFAULT CONFIGURATION */
@@ -123,6 +196,7 @@ typedef struct s_CONFIG_STRUCT
 #define s_CONFIG_DEFAULT_PF_NOISE_TURN							6
 #define s_CONFIG_DEFAULT_PF_NOISE_TAG							80
 #define s_CONFIG_DEFAULT_PF_NOISE_WALL							1
+#define s_CONFIG_DEFAULT_PF_SIMD								1
 
 // -- Robot --
 #define s_CONFIG_DEFAULT_ROBOT_ID								1
@@ -150,11 +224,62 @@ typedef struct s_CONFIG_STRUCT
 #define s_CONFIG_DEFAULT_NETWORK_BITRATE						153600
 #define s_CONFIG_DEFAULT_NETWORK_TDMA_SLOT_NUM					8
 #define s_CONFIG_DEFAULT_NETWORK_TDMA_PERIOD					1000
+#define s_CONFIG_DEFAULT_NETWORK_TDMA_SYNC						0
+#define s_CONFIG_DEFAULT_NETWORK_TDMA_DYNAMIC					0
+
+// -- Scheduler --
+#define s_CONFIG_DEFAULT_SCHEDULER_MINOR_CYCLE					100
+#define s_CONFIG_DEFAULT_SCHEDULER_EXECUTOR						"cyclic"
+#define s_CONFIG_DEFAULT_SCHEDULER_PRIORITY						"dm"
+#define s_CONFIG_DEFAULT_SCHEDULER_EVENT_LOOP					1
+#define s_CONFIG_DEFAULT_SCHEDULER_WATCHDOG						0
+// Task table: { period, phase, deadline, wcet, criticality }
+#define s_CONFIG_DEFAULT_TASK_MISSION			{ 100,	0,	100,	5,	s_CONFIG_CRITICALITY_LOW }
+#define s_CONFIG_DEFAULT_TASK_NAVIGATE			{ 100,	0,	100,	20,	s_CONFIG_CRITICALITY_LOW }
+#define s_CONFIG_DEFAULT_TASK_CONTROL			{ 500,	0,	500,	20,	s_CONFIG_CRITICALITY_HIGH }
+#define s_CONFIG_DEFAULT_TASK_REFINE			{ 100,	0,	100,	15,	s_CONFIG_CRITICALITY_LOW }
+#define s_CONFIG_DEFAULT_TASK_REPORT			{ 100,	0,	100,	2,	s_CONFIG_CRITICALITY_LOW }
+#define s_CONFIG_DEFAULT_TASK_COMMUNICATE		{ 1000,	s_CONFIG_TASK_PHASE_TDMA,	1000,	20,	s_CONFIG_CRITICALITY_LOW }
+#define s_CONFIG_DEFAULT_TASK_AVOID				{ 100,	0,	500,	5,	s_CONFIG_CRITICALITY_HIGH }
+
+// -- Overload manager --
+#define s_CONFIG_DEFAULT_OVERLOAD_ENABLE						1
+#define s_CONFIG_DEFAULT_OVERLOAD_TRIGGER						1
+#define s_CONFIG_DEFAULT_OVERLOAD_RECOVER						20
+#define s_CONFIG_DEFAULT_OVERLOAD_SLACK							50
+
+// -- Adaptive workload controller --
+#define s_CONFIG_DEFAULT_ADAPT_ENABLE							1
+#define s_CONFIG_DEFAULT_ADAPT_TARGET							70
+#define s_CONFIG_DEFAULT_ADAPT_PERIOD							1000
+#define s_CONFIG_DEFAULT_ADAPT_PARTICLES_MIN					200
+#define s_CONFIG_DEFAULT_ADAPT_EVAL_STEP_MAX					3
+#define s_CONFIG_DEFAULT_ADAPT_SECTORS_MIN						1
+
+// -- Reader threads --
+#define s_CONFIG_DEFAULT_READER_ENABLE							0
+#define s_CONFIG_DEFAULT_READER_OI_PERIOD						50
+
+// -- Trace --
+#define s_CONFIG_DEFAULT_TRACE_ENABLE							0
+#define s_CONFIG_DEFAULT_TRACE_EVENTS							65536
+#define s_CONFIG_DEFAULT_TRACE_PATH								"./trace.json"
+
+// -- Real-time hardening --
+#define s_CONFIG_DEFAULT_RT_ENABLE								0
+#define s_CONFIG_DEFAULT_RT_CPU									-1
+#define s_CONFIG_DEFAULT_RT_PRIORITY							90
+
+// -- Simulation --
+#define s_CONFIG_DEFAULT_SIM_ENABLE								0
+#define s_CONFIG_DEFAULT_SIM_SEED								1
+#define s_CONFIG_DEFAULT_SIM_DURATION							900
 
 /* -- Shared Variables -- */
 extern config_t g_config;
 
 /* -- Function Prototypes -- */
-void config_load(void);
+void config_load(void); // Load ./res/config.ini
+void config_load_file(const char *path); // Load given configuration file
 
 #endif /* __CONFIG_H */
@@ -0,0 +1,211 @@
+/**
+ * @file	eventloop.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Event loop library. The scheduler sleeps until the next release in
+ * epoll_wait() on a timerfd armed with the absolute release instant, together
+ * with the UDP and serial descriptors. Input is handled as soon as it arrives
+ * in the idle time instead of waiting for the task that polls it.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+/* project libraries */
+#include "eventloop.h"
+
+/* -- Defines -- */
+
+/* -- Types -- */
+
+/**
+ * @brief Registered descriptor
+ */
+typedef struct s_EVENTLOOP_SOURCE_STRUCT
+{
+	int fd; // Descriptor
+	eventloop_handler_t handler; // Called when fd is readable
+	const char *name; // Short name for the statistics
+	cnt_t events; // Number of times the handler was called
+
+} eventloop_source_t;
+
+/* -- Global Variables -- */
+static int eventloop_epfd = -1; // epoll instance
+static int eventloop_tfd = -1; // Release timer
+static eventloop_source_t eventloop_sources[s_EVENTLOOP_FD_NUM];
+static int eventloop_source_num = 0;
+
+/* -- Functions -- */
+
+/**
+ * Create epoll instance and release timer
+ * @return s_OK if successful, s_ERROR if failed
+ */
+int eventloop_init(void)
+{
+	struct epoll_event ev;
+
+	eventloop_epfd = epoll_create1(EPOLL_CLOEXEC);
+	eventloop_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	if(eventloop_epfd < 0 || eventloop_tfd < 0) {
+		printf("eventloop_init: could not create epoll instance or timer (%s).\n", strerror(errno));
+		eventloop_destroy();
+		return s_ERROR;
+	}
+
+	// The timer is not a source, it is recognized by the index UINT32_MAX
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = UINT32_MAX;
+	if(epoll_ctl(eventloop_epfd, EPOLL_CTL_ADD, eventloop_tfd, &ev) < 0) {
+		printf("eventloop_init: could not watch timer (%s).\n", strerror(errno));
+		eventloop_destroy();
+		return s_ERROR;
+	}
+	eventloop_source_num = 0;
+
+	return s_OK;
+}
+
+/**
+ * Close epoll instance and release timer
+ * @return Void
+ */
+void eventloop_destroy(void)
+{
+	if(eventloop_epfd >= 0)
+		close(eventloop_epfd);
+	if(eventloop_tfd >= 0)
+		close(eventloop_tfd);
+	eventloop_epfd = -1;
+	eventloop_tfd = -1;
+}
+
+/**
+ * Register descriptor
+ * @param fd Descriptor, watched for input (level-triggered)
+ * @param handler Called whenever fd is readable, must not block
+ * @param name Short name for the statistics
+ * @return s_OK if successful, s_ERROR if failed
+ */
+int eventloop_add(int fd, eventloop_handler_t handler, const char *name)
+{
+	struct epoll_event ev;
+	eventloop_source_t *src;
+
+	if(eventloop_epfd < 0 || fd < 0 || eventloop_source_num == s_EVENTLOOP_FD_NUM)
+		return s_ERROR;
+
+	src = &eventloop_sources[eventloop_source_num];
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = (uint32_t)eventloop_source_num;
+	if(epoll_ctl(eventloop_epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		printf("eventloop_add: could not watch %s (%s).\n", name, strerror(errno));
+		return s_ERROR;
+	}
+	src->fd = fd;
+	src->handler = handler;
+	src->name = name;
+	src->events = 0;
+	eventloop_source_num++;
+
+	return s_OK;
+}
+
+/**
+ * Handle input until the release instant
+ * @param release Absolute release instant (CLOCK_MONOTONIC)
+ * @param lock Mutex held while a handler runs, NULL if none is needed
+ * @return s_OK when the release is reached, s_ERROR if the loop is not initialized
+ */
+int eventloop_wait_until(const struct timespec *release, pthread_mutex_t *lock)
+{
+	struct epoll_event events[s_EVENTLOOP_FD_NUM + 1];
+	struct itimerspec its;
+	eventloop_source_t *src;
+	uint64_t expirations;
+	int n, i;
+
+	if(eventloop_epfd < 0)
+		return s_ERROR;
+
+	// Arm the timer, a release in the past expires at once
+	memset(&its, 0, sizeof(its));
+	its.it_value = *release;
+	if(its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+		its.it_value.tv_nsec = 1;
+	if(timerfd_settime(eventloop_tfd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+		return s_ERROR;
+
+	while(1)
+	{
+		n = epoll_wait(eventloop_epfd, events, s_EVENTLOOP_FD_NUM + 1, -1);
+		if(n < 0) {
+			if(errno == EINTR)
+				continue;
+			return s_ERROR;
+		}
+
+		// Input first, so that it is not left waiting for a whole cycle
+		for(i = 0; i < n; i++)
+		{
+			if(events[i].data.u32 == UINT32_MAX)
+				continue;
+			src = &eventloop_sources[events[i].data.u32];
+
+			// A hung up device would wake us up forever
+			if(events[i].events & (EPOLLHUP | EPOLLERR)) {
+				printf("eventloop: %s hung up, no longer watched.\n", src->name);
+				epoll_ctl(eventloop_epfd, EPOLL_CTL_DEL, src->fd, NULL);
+				continue;
+			}
+
+			if(lock != NULL)
+				pthread_mutex_lock(lock);
+			src->handler();
+			src->events++;
+			if(lock != NULL)
+				pthread_mutex_unlock(lock);
+		}
+
+		// Release reached
+		for(i = 0; i < n; i++)
+		{
+			if(events[i].data.u32 == UINT32_MAX) {
+				if(read(eventloop_tfd, &expirations, sizeof(expirations)) < 0 && errno == EAGAIN)
+					break;
+				return s_OK;
+			}
+		}
+	}
+}
+
+/**
+ * Print handled events per descriptor
+ * @return Void
+ */
+void eventloop_dump_statistics(void)
+{
+	int i;
+
+	if(eventloop_epfd < 0)
+		return;
+
+	printf("Event loop input:\t\t");
+	for(i = 0; i < eventloop_source_num; i++)
+		printf("%s %llu%s", eventloop_sources[i].name, eventloop_sources[i].events,
+			i + 1 < eventloop_source_num ? ", " : "\n");
+	if(eventloop_source_num == 0)
+		printf("none\n");
+}
@@ -0,0 +1,38 @@
+/**
+ * @file	eventloop.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Event loop (epoll + timerfd) library header file.
+ */
+
+#ifndef __EVENTLOOP_H
+#define __EVENTLOOP_H
+
+/* -- Includes -- */
+/* system libraries */
+#include <pthread.h>
+#include <time.h>
+/* project libraries */
+#include "def.h"
+
+/* -- Types -- */
+
+/**
+ * @brief Handler called when a registered descriptor is readable
+ */
+typedef void (*eventloop_handler_t)(void);
+
+/* -- Constants -- */
+#define s_EVENTLOOP_FD_NUM				8 // Maximum number of registered descriptors
+
+/* -- Function Prototypes -- */
+int eventloop_init(void); // Create epoll instance and release timer
+void eventloop_destroy(void); // Close epoll instance and release timer
+int eventloop_add(int fd, eventloop_handler_t handler, const char *name); // Call handler whenever fd is readable
+int eventloop_wait_until(const struct timespec *release, pthread_mutex_t *lock); // Handle events until release
+void eventloop_dump_statistics(void); // Print handled events per descriptor
+
+#endif /* __EVENTLOOP_H */
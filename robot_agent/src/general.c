@@ -81,43 +81,6 @@ void general_int2bytes(int integer, unsigned char *byte_high, unsigned char *byt
     *byte_low = (num) & 0xFF;
 }
 
-/**
- * Random number based on normal (gaussian) distribution
- * @source http://c-faq.com/lib/gaussian.html [Donald E. Knuth]
- * @param mu Mean of gaussian
- * @param sigma Variance of gaussian
- * @return Random number based on normal distribution
- */
-double general_gaussrand(double mu, double sigma)
-{
-    static double V1, V2, S;
-    static int phase = 0;
-    double X;
-
-    if(phase == 0)
-    {
-        do
-        {
-            double U1 = (double)rand() / RAND_MAX;
-            double U2 = (double)rand() / RAND_MAX;
-
-            V1 = 2 * U1 - 1;
-            V2 = 2 * U2 - 1;
-            S = V1 * V1 + V2 * V2;
-        } while(S >= 1 || S == 0);
-
-        X = V1 * sqrt(-2 * log(S) / S);
-    }
-    else
-    {
-        X = V2 * sqrt(-2 * log(S) / S);
-    }
-
-    phase = 1 - phase;
-
-    return X * sigma + mu;
-}
-
 /**
  * Calculate Gaussian
  * @param mu Mean of gaussian
@@ -24,7 +24,6 @@ int general_bytes2int(unsigned char byte_high, unsigned char byte_low); // Conve
 unsigned int general_bytes2uint(unsigned char byte_high, unsigned char byte_low); // Convert two bytes to unsigned int
 void general_int2bytes(int integer, unsigned char *byte_high, unsigned char *byte_low); // Convert int to two bytes (two's complement)
 
-double general_gaussrand(double mu, double sigma); // Random number based on normal (gaussian) distribution
 float general_gaussian(float mu, float sigma, int x); // Calculate Gaussian
 
 float general_dist_squared(int x1, int y1, int x2, int y2); // Calculate squared distance between two points
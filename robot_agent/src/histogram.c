@@ -0,0 +1,152 @@
+/**
+ * @file	histogram.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Fixed-memory histogram library. Values below 2^s_HISTOGRAM_SUB_BITS get
+ * their own bucket, larger values share a bucket with neighbours that have the
+ * same most significant bits, so the relative error stays constant.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <string.h>
+/* project libraries */
+#include "histogram.h"
+
+/* -- Defines -- */
+
+/* -- Functions -- */
+
+/**
+ * Get bucket index of a value
+ * @param value Value
+ * @return Bucket index
+ */
+static int histogram_bucket(unsigned long long value)
+{
+	int e;
+
+	if(value < s_HISTOGRAM_SUB_COUNT)
+		return (int)value;
+
+	// Position of most significant bit
+	e = 63 - __builtin_clzll(value);
+
+	return (e - s_HISTOGRAM_SUB_BITS + 1) * s_HISTOGRAM_SUB_COUNT
+		+ (int)(value >> (e - s_HISTOGRAM_SUB_BITS)) - s_HISTOGRAM_SUB_COUNT;
+}
+
+/**
+ * Get lowest value that falls into a bucket
+ * @param bucket Bucket index
+ * @param width Pointer to memory where to store bucket width (can be NULL)
+ * @return Lowest value of the bucket
+ */
+static unsigned long long histogram_bucket_low(int bucket, unsigned long long *width)
+{
+	int e, sub;
+
+	if(bucket < s_HISTOGRAM_SUB_COUNT)
+	{
+		if(width != NULL)
+			*width = 1;
+		return (unsigned long long)bucket;
+	}
+
+	e = bucket / s_HISTOGRAM_SUB_COUNT + s_HISTOGRAM_SUB_BITS - 1;
+	sub = bucket % s_HISTOGRAM_SUB_COUNT;
+
+	if(width != NULL)
+		*width = 1ULL << (e - s_HISTOGRAM_SUB_BITS);
+
+	return (unsigned long long)(s_HISTOGRAM_SUB_COUNT + sub) << (e - s_HISTOGRAM_SUB_BITS);
+}
+
+/**
+ * Clear all recorded values
+ * @param h Pointer to histogram structure
+ * @return Void
+ */
+void histogram_reset(histogram_t *h)
+{
+	memset(h, 0, sizeof(histogram_t));
+}
+
+/**
+ * Record one value
+ * @param h Pointer to histogram structure
+ * @param value Value to record
+ * @return Void
+ */
+void histogram_record(histogram_t *h, unsigned long long value)
+{
+	// Clamp to the largest representable value
+	if(value >= (1ULL << s_HISTOGRAM_MAX_BITS))
+		value = (1ULL << s_HISTOGRAM_MAX_BITS) - 1;
+
+	h->buckets[histogram_bucket(value)]++;
+
+	if(h->count == 0 || value < h->min)
+		h->min = value;
+	if(value > h->max)
+		h->max = value;
+
+	h->sum += value;
+	h->count++;
+}
+
+/**
+ * Mean of recorded values
+ * @param h Pointer to histogram structure
+ * @return Mean value, 0 if nothing was recorded
+ */
+double histogram_mean(histogram_t *h)
+{
+	if(h->count == 0)
+		return 0;
+
+	return (double)h->sum / (double)h->count;
+}
+
+/**
+ * Value at given percentile
+ * @param h Pointer to histogram structure
+ * @param percent Percentile (0 - 100)
+ * @return Middle of the bucket holding the percentile, limited to min/max
+ */
+unsigned long long histogram_percentile(histogram_t *h, double percent)
+{
+	int i;
+	cnt_t rank, seen = 0;
+	unsigned long long low, width, value;
+
+	if(h->count == 0)
+		return 0;
+
+	// Rank of the requested value (1 .. count)
+	rank = (cnt_t)((percent / 100.0) * (double)h->count + 0.5);
+	if(rank < 1)
+		rank = 1;
+	if(rank > h->count)
+		rank = h->count;
+
+	for(i = 0; i < s_HISTOGRAM_BUCKETS; i++)
+	{
+		seen += h->buckets[i];
+		if(seen >= rank)
+			break;
+	}
+
+	low = histogram_bucket_low(i, &width);
+	value = low + width / 2;
+
+	if(value < h->min)
+		value = h->min;
+	if(value > h->max)
+		value = h->max;
+
+	return value;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file	histogram.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Fixed-memory histogram library header file.
+ */
+
+#ifndef __HISTOGRAM_H
+#define __HISTOGRAM_H
+
+/* -- Includes -- */
+/* project libraries */
+#include "def.h"
+
+/* -- Constants -- */
+#define s_HISTOGRAM_SUB_BITS		4 // 2^4 sub-buckets per power of two (~6 % resolution)
+#define s_HISTOGRAM_SUB_COUNT		(1 << s_HISTOGRAM_SUB_BITS)
+#define s_HISTOGRAM_MAX_BITS		40 // Values are clamped to 2^40 - 1
+#define s_HISTOGRAM_BUCKETS			((s_HISTOGRAM_MAX_BITS - s_HISTOGRAM_SUB_BITS + 1) * s_HISTOGRAM_SUB_COUNT)
+
+/* -- Types -- */
+
+/**
+ * @brief Histogram structure (log-linear buckets, no allocation)
+ */
+typedef struct s_HISTOGRAM_STRUCT
+{
+	cnt_t buckets[s_HISTOGRAM_BUCKETS]; // Bucket counters
+
+	cnt_t count; // Number of recorded values
+	unsigned long long sum; // Sum of recorded values
+	unsigned long long min; // Smallest recorded value
+	unsigned long long max; // Largest recorded value
+
+} histogram_t;
+
+/* -- Function Prototypes -- */
+void histogram_reset(histogram_t *h); // Clear all recorded values
+void histogram_record(histogram_t *h, unsigned long long value); // Record one value
+double histogram_mean(histogram_t *h); // Mean of recorded values
+unsigned long long histogram_percentile(histogram_t *h, double percent); // Value at given percentile
+
+#endif /* __HISTOGRAM_H */
@@ -17,14 +17,22 @@
 #include <unistd.h>  /* UNIX standard function definitions */
 #include <sys/time.h>
 #include <sys/select.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
 /* project libraries */
 #include "openinterface.h"
 #include "config.h"
 #include "def.h"
 #include "general.h"
+#include "trace.h"
+#include "timelib.h"
 
 /* -- Defines -- */
 
+/* -- Function Prototypes -- */
+static int openinterface_sensors_latest(openinterface_t *ois, const unsigned int sensor_id); // Update sensors from reader sample
+
 /* -- Functions -- */
 
 /**
@@ -38,9 +46,12 @@ openinterface_t *openinterface_open(char *device_path)
 	openinterface_t *ois = (openinterface_t *) malloc(sizeof(openinterface_t));
 	// Openinterface sensor structure
 	ois->oiss = (openinterface_sensor_t *) malloc(sizeof(openinterface_sensor_t));
+	memset(ois->oiss, 0, sizeof(openinterface_sensor_t));
 
 	// Open serial port
 	ois->sps = serialport_open(device_path);
+	// No reader thread yet, sensors are requested by the caller
+	ois->reader_run = s_FALSE;
 
 	// Configure serial port
 	serialport_config(ois->sps, 57600);
@@ -65,6 +76,9 @@ int openinterface_close(openinterface_t *ois)
 {
 	int res;
 
+	// Stop reader thread before the port goes away
+	openinterface_reader_stop(ois);
+
 	// Stop robot if it still runs
 	openinterface_full(ois);
 	// Stop Motion
@@ -119,20 +133,17 @@ int openinterface_full(openinterface_t *ois)
  */
 int openinterface_drive(openinterface_t *ois, int velocity, int radius)
 {
-	int res = 0;
-	unsigned char velocity_data[2], radius_data[2];
+	int res;
+	unsigned char cmd[5] = {s_OI_CMD_DRIVE};
 
 	// Convert velocity int to bytes
-	general_int2bytes(velocity, &velocity_data[0], &velocity_data[1]);
+	general_int2bytes(velocity, &cmd[1], &cmd[2]);
 	// Convert radius int to bytes
-	general_int2bytes(radius, &radius_data[0], &radius_data[1]);
+	general_int2bytes(radius, &cmd[3], &cmd[4]);
 
-	// Send command with drive parameters
-	res += serialport_byte(ois->sps, s_OI_CMD_DRIVE);
-	res += serialport_byte(ois->sps, velocity_data[0]);
-	res += serialport_byte(ois->sps, velocity_data[1]);
-	res += serialport_byte(ois->sps, radius_data[0]);
-	res += serialport_byte(ois->sps, radius_data[1]);
+	// Send command with drive parameters in one write, so that it can not
+	// interleave with sensor requests of the reader thread
+	res = serialport_write(ois->sps, cmd, 5);
 
 	// Error check
 	if(res < 5)
@@ -150,20 +161,16 @@ int openinterface_drive(openinterface_t *ois, int velocity, int radius)
  */
 int openinterface_drive_direct(openinterface_t *ois, int right, int left)
 {
-	int res = 0;
-	unsigned char right_data[2], left_data[2];
+	int res;
+	unsigned char cmd[5] = {s_OI_CMD_DRIVE_DIRECT};
 
 	// Convert right int to bytes
-	general_int2bytes(right, &right_data[0], &right_data[1]);
+	general_int2bytes(right, &cmd[1], &cmd[2]);
 	// Convert left int to bytes
-	general_int2bytes(left, &left_data[0], &left_data[1]);
+	general_int2bytes(left, &cmd[3], &cmd[4]);
 
-	// Send command with drive parameters
-	res += serialport_byte(ois->sps, s_OI_CMD_DRIVE_DIRECT);
-	res += serialport_byte(ois->sps, right_data[0]);
-	res += serialport_byte(ois->sps, right_data[1]);
-	res += serialport_byte(ois->sps, left_data[0]);
-	res += serialport_byte(ois->sps, left_data[1]);
+	// Send command with drive parameters in one write
+	res = serialport_write(ois->sps, cmd, 5);
 
 	// Error check
 	if(res < 5)
@@ -186,26 +193,48 @@ int openinterface_sensor_get(openinterface_t *ois, const unsigned char id, const
 	unsigned char req[2] = {s_OI_CMD_SENSORS, id};
 	// Read packet
 	unsigned char *bufptr;     // Current char in buffer
-	int  nbytes, tbytes, n;    // Number of bytes read
+	int  nbytes, tbytes;       // Number of bytes read
+	struct timespec ts_deadline, ts_now;
+	long long remaining;
+
+	// No device, do not wait for the timeout
+	if (ois->sps->descriptor < 0)
+		return s_ERROR;
 
 	// Prepare select()
 	struct timeval tv;
-	tv.tv_sec = 1;      // Set two second timeout
-	tv.tv_usec = 0;
 	fd_set infds;
-	FD_ZERO(&infds);
-	FD_SET(ois->sps->descriptor, &infds);
 
 	// Request sensor update
+	trace_event(s_TRACE_EVENT_SERIAL_REQ, id, len);
 	serialport_write(ois->sps, req, 2);
 
+	// The whole reply must arrive before one deadline, not every byte
+	// within its own timeout
+	clock_gettime(CLOCK_MONOTONIC, &ts_deadline);
+	timelib_timespec_add_ms(&ts_deadline, s_OI_SENSOR_TIMEOUT);
+
 	// Read sensor data
 	tbytes = 0;
 	bufptr = data;
 
-	while((n = select(ois->sps->descriptor + 1, &infds, NULL, NULL, &tv)) > 0)
+	// A signal (the budget watchdog) ends the wait as well
+	while(1)
 	{
+		clock_gettime(CLOCK_MONOTONIC, &ts_now);
+		remaining = timelib_timespec_diff_us(ts_now, ts_deadline);
+		if (remaining <= 0)
+			break;
+		tv.tv_sec = remaining / 1000000;
+		tv.tv_usec = remaining % 1000000;
+		FD_ZERO(&infds);
+		FD_SET(ois->sps->descriptor, &infds);
+		if (select(ois->sps->descriptor + 1, &infds, NULL, NULL, &tv) <= 0)
+			break;
+
 		nbytes = (int)read(ois->sps->descriptor, bufptr, 1);
+		if (nbytes <= 0)
+			break;
 
 		if (tbytes < (len + 1)) {
 			tbytes += nbytes;
@@ -216,10 +245,26 @@ int openinterface_sensor_get(openinterface_t *ois, const unsigned char id, const
 			break;
 		}
 	}
+	trace_event(s_TRACE_EVENT_SERIAL_RESP, id, tbytes);
+
+	// Incomplete packet (timeout)
+	if (tbytes != len)
+		return s_ERROR;
 
 	return s_OK;
 }
 
+/**
+ * Drop bytes received outside a sensor request (a reply that came after its
+ * timeout), so they can not be taken for the start of the next reply
+ * @param ois Pointer to OpenInterface structure
+ * @return Number of dropped bytes, s_ERROR if nothing could be read
+ */
+int openinterface_flush(openinterface_t *ois)
+{
+	return serialport_flush_input(ois->sps);
+}
+
 
 /**
  * Updates all sensor data
@@ -234,9 +279,14 @@ int openinterface_sensors_update(openinterface_t *ois, const unsigned int sensor
 	// Array for data acquisition
 	unsigned char data[52];
 
-	// Request all sensor data
-	openinterface_sensor_get(ois, sensor_id, size, data);
+	// The reader thread polls the sensors, only take its latest sample
+	if (__atomic_load_n(&ois->reader_run, __ATOMIC_ACQUIRE))
+		return openinterface_sensors_latest(ois, sensor_id);
 
+	// Request all sensor data, keep the previous values if the reply did
+	// not arrive complete (timeout or watchdog)
+	if(openinterface_sensor_get(ois, sensor_id, size, data) == s_ERROR)
+		return s_ERROR;
 
 	// Update sensor measurement values
 	// !!! FUNCTION IS NOT COMPLETE. UPDATES ONLY FEW SENSORS
@@ -347,19 +397,16 @@ int openinterface_LEDs(	openinterface_t *ois,
 						unsigned char power_color,
 						unsigned char power_intensity)
 {
-	int res = 0;
-	unsigned char leds = 0;
+	int res;
+	unsigned char cmd[4] = {s_OI_CMD_LEDS, 0, power_color, power_intensity};
 
 	if(play > 0)
-		leds += 2;
+		cmd[1] += 2;
 	if(advance > 0)
-		leds += 8;
+		cmd[1] += 8;
 
-	// Send command with drive parameters
-	res += serialport_byte(ois->sps, s_OI_CMD_LEDS);
-	res += serialport_byte(ois->sps, leds);
-	res += serialport_byte(ois->sps, power_color);
-	res += serialport_byte(ois->sps, power_intensity);
+	// Send command with LED parameters in one write
+	res = serialport_write(ois->sps, cmd, 4);
 
 	// Error check
 	if(res < 4)
@@ -367,3 +414,133 @@ int openinterface_LEDs(	openinterface_t *ois,
 	else
 		return s_OK;
 }
+
+/**
+ * Update sensor values from the latest sample of the reader thread. Distance
+ * and angle are reported since the previous update, like the device does
+ * @param opis Pointer to OpenInterface structure
+ * @param sensor_id ID of sensor packet
+ * @return s_OK if successful, s_ERROR if the reader does not provide the packet
+ */
+static int openinterface_sensors_latest(openinterface_t *ois, const unsigned int sensor_id)
+{
+	openinterface_sample_t sample;
+
+	slot_read(&ois->reader_slot, &sample, sizeof(sample));
+
+	switch(sensor_id)
+	{
+	// Sensor Packet 0, 6 (reader polls packet 0)
+	case s_OI_SENSOR_PACKET_0 :
+	case s_OI_SENSOR_PACKET_6 :
+		ois->oiss->wheeldrop_bump			= sample.wheeldrop_bump;
+		ois->oiss->wall						= sample.wall;
+		// fall through
+	// Sensor Packet 2
+	case s_OI_SENSOR_PACKET_2 :
+		ois->oiss->distance					= sample.distance - ois->reader_distance;
+		ois->oiss->angle					= sample.angle - ois->reader_angle;
+		ois->reader_distance				= sample.distance;
+		ois->reader_angle					= sample.angle;
+		break;
+	// Sensor Packet 1
+	case s_OI_SENSOR_PACKET_1 :
+		ois->oiss->wheeldrop_bump			= sample.wheeldrop_bump;
+		ois->oiss->wall						= sample.wall;
+		break;
+	// Other
+	default :
+		return s_ERROR;
+		break;
+	}
+
+	return s_OK;
+}
+
+/**
+ * Reader thread: poll sensor packet 0 periodically and publish the latest
+ * bump and wall sensors with the accumulated distance and angle
+ * @param arg Pointer to OpenInterface structure
+ * @return NULL
+ */
+static void *openinterface_reader(void *arg)
+{
+	openinterface_t *ois = (openinterface_t *)arg;
+	openinterface_sample_t sample;
+	unsigned char data[s_OI_SENSOR_PACKET_0_SIZE];
+	struct timespec ts_release, ts_now;
+	sigset_t mask;
+
+	// SIGINT is handled by the main thread
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+	memset(&sample, 0, sizeof(sample));
+	clock_gettime(CLOCK_MONOTONIC, &ts_release);
+
+	while(__atomic_load_n(&ois->reader_run, __ATOMIC_ACQUIRE))
+	{
+		// Only complete packets are published
+		if(openinterface_sensor_get(ois, s_OI_SENSOR_PACKET_0, s_OI_SENSOR_PACKET_0_SIZE, data) == s_OK)
+		{
+			sample.wheeldrop_bump = data[0];
+			sample.wall = data[1];
+			sample.distance += general_bytes2int(data[12], data[13]);
+			sample.angle += general_bytes2int(data[14], data[15]);
+			slot_write(&ois->reader_slot, &sample, sizeof(sample));
+		}
+
+		// Sleep till next poll, start over if a timeout made us miss it
+		timelib_timespec_add_ms(&ts_release, ois->reader_period);
+		clock_gettime(CLOCK_MONOTONIC, &ts_now);
+		if(timelib_timespec_diff_us(ts_release, ts_now) > 0)
+			ts_release = ts_now;
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts_release, NULL) == EINTR)
+			;
+	}
+
+	return NULL;
+}
+
+/**
+ * Start reader thread. Afterwards openinterface_sensors_update() only reads
+ * the latest sample and never blocks on the serial port
+ * @param opis Pointer to OpenInterface structure
+ * @param period Sensor polling period (ms)
+ * @return s_OK if successful, s_ERROR if failed
+ */
+int openinterface_reader_start(openinterface_t *ois, int period)
+{
+	if(ois->sps->descriptor < 0)
+		return s_ERROR;
+
+	slot_init(&ois->reader_slot);
+	ois->reader_distance = 0;
+	ois->reader_angle = 0;
+	ois->reader_period = period;
+
+	__atomic_store_n(&ois->reader_run, s_TRUE, __ATOMIC_RELEASE);
+	if(pthread_create(&ois->reader, NULL, openinterface_reader, ois) != 0)
+	{
+		printf("openinterface_reader_start: could not create reader thread.\n");
+		__atomic_store_n(&ois->reader_run, s_FALSE, __ATOMIC_RELEASE);
+		return s_ERROR;
+	}
+
+	return s_OK;
+}
+
+/**
+ * Stop reader thread (waits for its current request to finish)
+ * @param opis Pointer to OpenInterface structure
+ * @return Void
+ */
+void openinterface_reader_stop(openinterface_t *ois)
+{
+	if(!__atomic_load_n(&ois->reader_run, __ATOMIC_ACQUIRE))
+		return;
+
+	__atomic_store_n(&ois->reader_run, s_FALSE, __ATOMIC_RELEASE);
+	pthread_join(ois->reader, NULL);
+}
@@ -13,7 +13,10 @@
 #define __OPENINTERFACE_H
 
 /* -- Includes -- */
+#include <pthread.h>
+
 #include "serialport.h"
+#include "slot.h"
 
 /* -- Types -- */
 
@@ -103,8 +106,27 @@ typedef struct s_OPENINTERFACE_STRUCT
 	serialport_t *sps; // Pointer to serial port structure
 	openinterface_sensor_t *oiss; // Pointer to Open Interface sensor structure
 
+	pthread_t reader; // Sensor reader thread
+	int reader_run; // Reader thread is running (s_TRUE/s_FALSE)
+	int reader_period; // Sensor polling period of the reader thread (ms)
+	slot_t reader_slot; // Latest sample published by the reader thread
+	int reader_distance; // Distance total at the last distance update (mm)
+	int reader_angle; // Angle total at the last angle update (degrees)
+
 } openinterface_t;
 
+/**
+ * @brief Sample published by the Open Interface reader thread
+ */
+typedef struct s_OPENINTERFACE_SAMPLE_STRUCT
+{
+	unsigned char wheeldrop_bump; // Bump and wheel drop sensors
+	unsigned char wall; // Wall sensor
+	int distance; // Distance travelled since the reader started (mm)
+	int angle; // Angle turned since the reader started (degrees)
+
+} openinterface_sample_t;
+
 /* -- Constants -- */
 
 // Commands
@@ -151,6 +173,9 @@ typedef struct s_OPENINTERFACE_STRUCT
 #define s_OI_SENSOR_PACKET_5_SIZE		12 // 5th block of sensors
 #define s_OI_SENSOR_PACKET_6_SIZE		52 // All sensors
 
+// Overall time a whole sensor reply may take (ms), 52 bytes take 9 ms at 57600 baud
+#define s_OI_SENSOR_TIMEOUT				100
+
 /* -- Function Prototypes -- */
 // Communication
 openinterface_t *openinterface_open(char *device_path); // Open OpenInterface connection
@@ -165,6 +190,7 @@ int openinterface_drive(openinterface_t *ois, int velocity, int radius); // Send
 int openinterface_drive_direct(openinterface_t *ois, int right, int left); // Sends Direct Drive Command
 int openinterface_sensor_get(openinterface_t *ois, const unsigned char id, const unsigned char len, unsigned char *data); // Get one sensor request readings
 int openinterface_sensors_update(openinterface_t *ois, const unsigned int sensor_id, const unsigned int size); // Update one sensor packet
+int openinterface_flush(openinterface_t *ois); // Drop bytes received outside a sensor request
 int openinterface_distance_get(openinterface_t *ois); // Get travelled distance
 int openinterface_angle_get(openinterface_t *ois); // Get change of angle
 
@@ -174,4 +200,8 @@ int openinterface_LEDs(	openinterface_t *ois,
 						unsigned char power_color,
 						unsigned char power_intensity); // Control LEDs
 
+// Reader thread
+int openinterface_reader_start(openinterface_t *ois, int period); // Poll sensors from a dedicated thread
+void openinterface_reader_stop(openinterface_t *ois); // Stop reader thread
+
 #endif /* __OPENINTERFACE_H */
@@ -18,12 +18,45 @@
 #include "pf.h"
 #include "robot.h"
 #include "enviroment.h"
+#include "config.h"
+#include "general.h"
+#include "pf_simd.h"
+#include "rng.h"
 #include "debug.h"
 
  /* -- Defines -- */
 
 /* -- Functions -- */
 
+/**
+ * Allocate one particle array
+ * @param num Number of elements
+ * @return Pointer to array aligned to s_PF_ALIGN, NULL if out of memory
+ */
+static float *pf_alloc(int num)
+{
+	void *p;
+
+	if(posix_memalign(&p, s_PF_ALIGN, num * sizeof(float)) != 0)
+		return NULL;
+
+	return (float *)p;
+}
+
+/**
+ * Place particle at a random pose in the room
+ * @param pfs Pointer to particle filter structure
+ * @param envs Pointer to enviroment structure
+ * @param i Particle index
+ * @return Void
+ */
+static void pf_scatter(pf_t *pfs, enviroment_t *envs, int i)
+{
+	pfs->x[i] = rng_int(s_RNG_STREAM_PF, envs->room_max_width);
+	pfs->y[i] = rng_int(s_RNG_STREAM_PF, envs->room_max_height);
+	pfs->a[i] = rng_float(s_RNG_STREAM_PF) * (float)(M_PI * 2);
+}
+
 /**
  * Initialize particle filter
  * @param num Number of particles
@@ -50,29 +83,39 @@ pf_t *pf_init(	int num,
 
 	// Set number of particles
 	pfs->num = num;
+	pfs->num_max = num;
+
+	// Set noise and size
+	pfs->move_noise = move_noise;
+	pfs->turn_noise = turn_noise;
+	pfs->sense_tag_noise = sense_tag_noise;
+	pfs->sense_wall_noise = sense_wall_noise;
+	pfs->radius = radius;
 
 	// Allocate memory
-	pfs->particles = malloc(pfs->num  * sizeof(robot_t));
+	pfs->x = pf_alloc(pfs->num);
+	pfs->y = pf_alloc(pfs->num);
+	pfs->a = pf_alloc(pfs->num);
+	pfs->w = pf_alloc(pfs->num);
+	pfs->bx = pf_alloc(pfs->num);
+	pfs->by = pf_alloc(pfs->num);
+	pfs->ba = pf_alloc(pfs->num);
+	pfs->bw = pf_alloc(pfs->num);
+	pfs->u = pf_alloc(2 * pfs->num);
+	pfs->idx = (int *) malloc(pfs->num * sizeof(int));
 
 	for(i = 0; i < pfs->num ; i++)
 	{
-		// Set random initial pose for particles (robots)
-		robot_set_pose(&pfs->particles[i],	rand() % envs->room_max_width,
-										 	rand() % envs->room_max_height,
-										 	fmod(rand(), M_PI * 2));
-		// Set noise
-		robot_set_noise(&pfs->particles[i],	move_noise,
-										  	turn_noise,
-										  	sense_tag_noise,
-										  	sense_wall_noise);
-
-		// Set initial weight
-		pfs->particles[i].radius = radius;
+		// Set random initial pose for particles
+		pf_scatter(pfs, envs, i);
 
 		// Set initial weight
-		pfs->particles[i].weight = (float)1 / (float)pfs->num;
+		pfs->w[i] = (float)1 / (float)pfs->num;
 	}
 
+	// Evaluate accuracy once, later it is updated in the background
+	pfs->accuracy = pf_accuracy(pfs, envs);
+
 	return pfs;
 }
 
@@ -83,8 +126,17 @@ pf_t *pf_init(	int num,
  */
 void pf_destroy(pf_t *pfs)
 {
-	// Free memory (Robot struct - particles)
-	free(pfs->particles);
+	// Free memory (particles)
+	free(pfs->x);
+	free(pfs->y);
+	free(pfs->a);
+	free(pfs->w);
+	free(pfs->bx);
+	free(pfs->by);
+	free(pfs->ba);
+	free(pfs->bw);
+	free(pfs->u);
+	free(pfs->idx);
 	// Free memory (Particle filter struct)
 	free(pfs);
 }
@@ -94,16 +146,46 @@ void pf_destroy(pf_t *pfs)
  * @param pfs Pointer to particle filter structure
  * @param distance Distance traveled (mm)
  * @param angle Angle change (Degrees)
+ * @param uncertain If larger than 0, the motion is not known and a large noise is added
  * @return Void
  */
 void pf_drive(pf_t *pfs, int distance, int angle, int uncertain)
 {
 	int i;
+	float d;
+
+	// Move all particles with the vector kernel if there is one. The large
+	// noise of an uncertain motion is rare and stays scalar
+	if(uncertain == 0 && pf_simd_drive(pfs->x, pfs->y, pfs->a, pfs->u, pfs->num,
+		distance, angle, pfs->move_noise, pfs->turn_noise) == s_OK)
+	{
+		return;
+	}
 
 	// Move all particles
 	for(i = 0; i < pfs->num; i++)
 	{
-		robot_drive(&pfs->particles[i], distance, angle, uncertain);
+		// Update angle
+		if(angle != 0)
+		{
+			pfs->a[i] = fmodf(pfs->a[i] - (angle + rng_gauss(s_RNG_STREAM_PF, 0, pfs->turn_noise)) * (float)(M_PI / 180), (float)(M_PI * 2));
+		}
+
+		// Update position
+		if(distance != 0)
+		{
+			d = distance + rng_gauss(s_RNG_STREAM_PF, 0, pfs->move_noise);
+			pfs->x[i] += cosf(pfs->a[i]) * d;
+			pfs->y[i] += sinf(pfs->a[i]) * d;
+		}
+
+		// Particle is uncertain about its action, add just large noise
+		if(uncertain > 0)
+		{
+			pfs->a[i] = fmodf(pfs->a[i] - rng_gauss(s_RNG_STREAM_PF, 0, s_CONFIG_PF_ANGLE_UNCERTANITY) * (float)(M_PI / 180), (float)(M_PI * 2));
+			pfs->x[i] += cosf(pfs->a[i]) * s_CONFIG_PF_DISTANCE_UNCERTANITY;
+			pfs->y[i] += sinf(pfs->a[i]) * s_CONFIG_PF_DISTANCE_UNCERTANITY;
+		}
 	}
 }
 
@@ -116,13 +198,44 @@ void pf_drive(pf_t *pfs, int distance, int angle, int uncertain)
  */
 void pf_weight_tag(pf_t *pfs, enviroment_t *envs, int tag_num)
 {
-	int i;
+	int i, n;
+	float dx, dy, prob;
+	float tx = envs->tags[tag_num].x;
+	float ty = envs->tags[tag_num].y;
+
+	// Vector kernel, then throw the particles outside the room back in
+	n = pf_simd_weight_tag(	pfs->x, pfs->y, pfs->w, pfs->u, pfs->idx, pfs->num, tx, ty,
+							envs->room_max_width, envs->room_max_height,
+							pfs->sense_tag_noise, s_CONFIG_RFID_SENSE_RADIUS);
+	if(n != s_ERROR)
+	{
+		for(i = 0; i < n; i++)
+		{
+			pf_scatter(pfs, envs, pfs->idx[i]);
+		}
+		return;
+	}
 
 	// Evaluate each particle
 	for(i = 0; i < pfs->num; i++)
 	{
-		pfs->particles[i].tag_num = tag_num;
-		robot_eval_tag(&pfs->particles[i], envs);
+		// Particles outside the room are unlikely, throw them back in
+		if( pfs->x[i] > envs->room_max_width ||
+			pfs->y[i] > envs->room_max_height ||
+			pfs->x[i] < 0 ||
+			pfs->y[i] < 0)
+		{
+			pfs->w[i] = 0.00001;
+			pf_scatter(pfs, envs, i);
+			continue;
+		}
+
+		dx = pfs->x[i] - tx;
+		dy = pfs->y[i] - ty;
+		prob = general_gaussian(sqrtf(dx * dx + dy * dy), pfs->sense_tag_noise, rng_int(s_RNG_STREAM_PF, s_CONFIG_RFID_SENSE_RADIUS)); // !!!
+		if(prob == 0)
+			prob = 0.00001;
+		pfs->w[i] = prob;
 	}
 }
 
@@ -130,80 +243,102 @@ void pf_weight_tag(pf_t *pfs, enviroment_t *envs, int tag_num)
  * Evaluate particles depending on how close to wall particle is
  * @param pfs Pointer to particle filter structure
  * @param envs Pointer to enviroment structure
- * @param tag_num RFID tag number
  * @return Void
  */
 void pf_weight_wall(pf_t *pfs, enviroment_t *envs)
 {
-	int i;
+	int i, j;
+	float res, dist;
 
 	// Evaluate each particle
 	for(i = 0; i < pfs->num; i++)
 	{
-		robot_eval_wall(&pfs->particles[i], envs);
+		// Particles outside the room are unlikely, throw them back in
+		if( pfs->x[i] > envs->room_max_width ||
+			pfs->y[i] > envs->room_max_height ||
+			pfs->x[i] < 0 ||
+			pfs->y[i] < 0)
+		{
+			pfs->w[i] = 0.00001;
+			pf_scatter(pfs, envs, i);
+			continue;
+		}
+
+		// Calculate distance to closest wall
+		res = 99999;
+		for(j = 0; j < envs->room_num; j++)
+		{
+			dist = sqrtf(general_dist2seg(	(int)pfs->x[i],
+											(int)pfs->y[i],
+											envs->room[j].point,
+											envs->room[(j + 1) % envs->room_num].point));
+			if(res > dist)
+				res = dist;
+		}
+
+		if(res > (pfs->radius - 10) && res < (pfs->radius + 10))
+			pfs->w[i] = 1;
+		else
+			pfs->w[i] = 0.1;
 	}
 }
 
 /**
- * Resample particles
+ * Resample particles (systematic, low variance): one random offset, then
+ * num equally spaced pointers walk the cumulative weights once. The copies
+ * go to the back buffer, which is swapped with the particle arrays
  * @param pfs Pointer to particle filter structure
  * @return Void
  */
 void pf_resample(pf_t *pfs)
 {
 	// Local variables
-	robot_t **resampled;
-	int i, index = (rand() % pfs->num);
-	float beta = 0;
-	float mw = 0, w_sum = 0;
-
-	// Allocate memory
-	resampled = (robot_t **)malloc(pfs->num * sizeof(robot_t *));
-	for(i = 0; i < pfs->num; i++)
-	{
-		resampled[i] = (robot_t *)malloc(sizeof(robot_t));
-	}
+	float *t;
+	int i, j = 0;
+	double step, pos, cum;
+	float w_sum = 0, rw_sum = 0;
 
-	// Find max weight
+	// Sum of weights
 	for(i = 0; i < pfs->num; i++)
 	{
-		if(mw < pfs->particles[i].weight)
-			mw = pfs->particles[i].weight;
+		w_sum += pfs->w[i];
 	}
-
-	// TEST !!!
-	debug_printf("MAX WEIGHT: %f\n", mw);
+	if(w_sum <= 0)
+		return;
 
 	// Resample
+	step = (double)w_sum / pfs->num;
+	pos = step * rng_float(s_RNG_STREAM_PF);
+	cum = pfs->w[0];
 	for(i = 0; i < pfs->num; i++)
 	{
-		beta += (float)rand() / ((float)RAND_MAX / (mw * 2));
-		while(beta > pfs->particles[index].weight)
+		while(pos > cum && j < pfs->num - 1)
 		{
-			beta -= pfs->particles[index].weight;
-			index = (index + 1) % pfs->num;
+			j++;
+			cum += pfs->w[j];
 		}
 
-		memcpy(resampled[i], &pfs->particles[index], sizeof(robot_t));
+		pfs->bx[i] = pfs->x[j];
+		pfs->by[i] = pfs->y[j];
+		pfs->ba[i] = pfs->a[j];
+		pfs->bw[i] = pfs->w[j];
 
 		// Calculate sum for normalization (so that sum of all weights is one)
-		w_sum += pfs->particles[index].weight;
-
+		rw_sum += pfs->w[j];
+		pos += step;
 	}
 
-	// Restore to particles array
+	// Normalize
 	for(i = 0; i < pfs->num; i++)
 	{
-		memcpy(&pfs->particles[i], resampled[i], sizeof(robot_t));
-		pfs->particles[i].weight = resampled[i]->weight / w_sum;
+		pfs->bw[i] /= rw_sum;
 	}
 
-	// Free memory
-	for(i = 0; i < pfs->num; i++)
-	{
-		free(resampled[i]);
-	}
-	free(resampled);
+	// Swap buffers
+	t = pfs->x; pfs->x = pfs->bx; pfs->bx = t;
+	t = pfs->y; pfs->y = pfs->by; pfs->by = t;
+	t = pfs->a; pfs->a = pfs->ba; pfs->ba = t;
+	t = pfs->w; pfs->w = pfs->bw; pfs->bw = t;
 }
 
 /**
@@ -222,12 +357,12 @@ void pf_estimate(pf_t *pfs, robot_t *robot)
 	for(i = 0; i < pfs->num; i++)
 	{
 		// Calculate position taking into account weights
-		ex += (float)pfs->particles[i].x * pfs->particles[i].weight;
-		ey += (float)pfs->particles[i].y * pfs->particles[i].weight;
+		ex += pfs->x[i] * pfs->w[i];
+		ey += pfs->y[i] * pfs->w[i];
 
 		// Calculate vector for heading direction
-		vx += pfs->particles[i].weight * cos(pfs->particles[i].a);
-		vy += pfs->particles[i].weight * sin(pfs->particles[i].a);
+		vx += pfs->w[i] * cosf(pfs->a[i]);
+		vy += pfs->w[i] * sinf(pfs->a[i]);
 	}
 
 	// Calculate angle from the vector
@@ -261,27 +396,27 @@ void pf_estimate(pf_t *pfs, robot_t *robot)
 void pf_random(pf_t *pfs, enviroment_t *envs, int tag_num)
 {
 	int i;
-	int num = rand() % 100; // Number of randomly drawn particles
+	int num = rng_int(s_RNG_STREAM_PF, 100); // Number of randomly drawn particles
 	int particle_id;
 
 	// Draw random particles and place them close to the read RFID tag
 	for(i = 0; i < num; i++)
 	{
 		// Randomly draw id of particle
-		particle_id = rand() % pfs->num;
+		particle_id = rng_int(s_RNG_STREAM_PF, pfs->num);
 
 		// Set random position near the read tag
-		pfs->particles[particle_id].x = envs->tags[tag_num].x + (300 - (rand() % 600));
-		pfs->particles[particle_id].y = envs->tags[tag_num].y + (300 - (rand() % 600));
+		pfs->x[particle_id] = envs->tags[tag_num].x + (300 - rng_int(s_RNG_STREAM_PF, 600));
+		pfs->y[particle_id] = envs->tags[tag_num].y + (300 - rng_int(s_RNG_STREAM_PF, 600));
 
 		// Randomize angle only once a while
 		/*if((rand() % 10) > 5)
 		{
-			pfs->particles[particle_id].a = fmod(rand(), M_PI * 2);
+			pfs->a[particle_id] = fmod(rand(), M_PI * 2);
 		}*/
 
 		// Give a low probability
-		pfs->particles[particle_id].weight = 0.00001;
+		pfs->w[particle_id] = 0.00001;
 	}
 }
 
@@ -294,7 +429,7 @@ void pf_random(pf_t *pfs, enviroment_t *envs, int tag_num)
 int pf_accuracy(pf_t *pfs, enviroment_t *envs)
 {
 	int i;
-	int xmin = 99999, xmax = 0, ymin = 99999, ymax = 0;
+	float xmin = 99999, xmax = 0, ymin = 99999, ymax = 0;
 	int width, height, area, field_area;
 	float accuracy;
 	int percent;
@@ -303,26 +438,26 @@ int pf_accuracy(pf_t *pfs, enviroment_t *envs)
 	for(i = 0; i < pfs->num; i++)
 	{
 		// Look only at good particles
-		if(pfs->particles[i].weight > 0.00001)
+		if(pfs->w[i] > 0.00001)
 		{
 			// Find MIN
-			if(xmin > pfs->particles[i].x)
-				xmin = pfs->particles[i].x;
+			if(xmin > pfs->x[i])
+				xmin = pfs->x[i];
 
-			if(ymin > pfs->particles[i].y)
-				ymin = pfs->particles[i].y;
+			if(ymin > pfs->y[i])
+				ymin = pfs->y[i];
 
 			// Find MAX
-			if(xmax < pfs->particles[i].x)
-				xmax = pfs->particles[i].x;
+			if(xmax < pfs->x[i])
+				xmax = pfs->x[i];
 
-			if(ymax < pfs->particles[i].y)
-				ymax = pfs->particles[i].y;
+			if(ymax < pfs->y[i])
+				ymax = pfs->y[i];
 		}
 	}
 
-	width = xmax - xmin;
-	height = ymax - ymin;
+	width = (int)xmax - (int)xmin;
+	height = (int)ymax - (int)ymin;
 	area = width * height;
 	field_area = envs->room_max_width * envs->room_max_height;
 
@@ -341,3 +476,61 @@ int pf_accuracy(pf_t *pfs, enviroment_t *envs)
 
 	return percent;
 }
+
+/**
+ * Change number of particles in use (within the allocated particles). Added
+ * particles are copies of randomly drawn particles in use. Dropped particles
+ * are a random subset: the resampler writes copies of one particle next to
+ * each other, so dropping the last ones could remove a whole pose hypothesis.
+ * Weights are normalized again over the particles in use
+ * @param pfs Pointer to particle filter structure
+ * @param num Number of particles
+ * @return Void
+ */
+void pf_set_num(pf_t *pfs, int num)
+{
+	int i, k;
+	float t, w_sum = 0;
+
+	if(num < 1)
+		num = 1;
+	if(num > pfs->num_max)
+		num = pfs->num_max;
+	if(num == pfs->num)
+		return;
+
+	// Fill the added particles from the ones in use
+	for(i = pfs->num; i < num; i++)
+	{
+		k = rng_int(s_RNG_STREAM_PF, pfs->num);
+		pfs->x[i] = pfs->x[k];
+		pfs->y[i] = pfs->y[k];
+		pfs->a[i] = pfs->a[k];
+		pfs->w[i] = pfs->w[k];
+	}
+
+	// Move a random subset of particles to the end and drop it (partial
+	// Fisher-Yates, the work is proportional to the dropped particles)
+	for(i = pfs->num - 1; i >= num; i--)
+	{
+		k = rng_int(s_RNG_STREAM_PF, i + 1);
+		t = pfs->x[i]; pfs->x[i] = pfs->x[k]; pfs->x[k] = t;
+		t = pfs->y[i]; pfs->y[i] = pfs->y[k]; pfs->y[k] = t;
+		t = pfs->a[i]; pfs->a[i] = pfs->a[k]; pfs->a[k] = t;
+		t = pfs->w[i]; pfs->w[i] = pfs->w[k]; pfs->w[k] = t;
+	}
+	pfs->num = num;
+
+	// Normalize weights
+	for(i = 0; i < pfs->num; i++)
+	{
+		w_sum += pfs->w[i];
+	}
+	if(w_sum > 0)
+	{
+		for(i = 0; i < pfs->num; i++)
+		{
+			pfs->w[i] /= w_sum;
+		}
+	}
+}
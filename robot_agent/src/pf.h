@@ -23,13 +23,31 @@
  */
 typedef struct s_PF_STRUCT
 {
-	robot_t *particles; // Array of particles (robots)
+	// Particles, stored as one array per field so that the loops only touch
+	// the fields they use. Arrays start on a s_PF_ALIGN boundary
+	float *x; // X coordinates (mm)
+	float *y; // Y coordinates (mm)
+	float *a; // Heading directions (radians)
+	float *w; // Weights
+	float *bx, *by, *ba, *bw; // Back buffer, resampling fills it and swaps it with x, y, a and w
+	float *u; // Scratch for the noise of the motion update (2 * num_max)
+	int *idx; // Scratch for the indices of the particles outside the room (num_max)
+
+	int num; // Number of particles in use
+	int num_max; // Number of particles allocated (upper bound of num)
+	int accuracy; // Last evaluated accuracy in percent (updated by a background job)
+
+	// Noise and size, the same for all particles
+	int move_noise; // Error created during forward or backward motion (mm)
+	float turn_noise; // Error created during turning (degrees)
+	int sense_tag_noise; // Error of tag read (mm)
+	int sense_wall_noise; // Error of wall read (mm)
+	int radius; // Particle radius - same as robot (mm)
 
-	int num; // Number of particles
-    
 } pf_t;
 
 /* -- Constants -- */
+#define s_PF_ALIGN					64 // Alignment of the particle arrays (bytes, a cache line)
 
 /* -- Function Prototypes -- */
 
@@ -48,6 +66,7 @@ void pf_resample(pf_t *pfs); // Resample particles
 void pf_estimate(pf_t *pfs, robot_t *robot); // Estimate robot pose according to particles
 void pf_random(pf_t *pfs, enviroment_t *envs, int tag_num); // Generate random particles near read RFID tag
 int pf_accuracy(pf_t *pfs, enviroment_t *envs); // Evaluate particle filter accuracy
+void pf_set_num(pf_t *pfs, int num); // Change number of particles in use
 
 
  #endif /* __PF_H */
\ No newline at end of file
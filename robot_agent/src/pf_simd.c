@@ -0,0 +1,774 @@
+/**
+ * @file	pf_simd.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Vectorised particle filter kernels, 8 (AVX2) or 4 (SSE2) particles at a
+ * time. Sine, cosine, logarithm and exponential are Cephes polynomials
+ * (single precision, as in sse_mathfun), so a whole vector is computed at
+ * once.
+ *
+ * The motion update draws the noise with the Box-Muller transform: one pair
+ * of uniform numbers gives the turn noise (cosine part) and the move noise
+ * (sine part) of a particle, the same normal distributions as
+ * rng_gauss.
+ *
+ * The tag weighting computes the likelihood of the distance to the read tag
+ * as general_gaussian does, without branches: particles outside the room
+ * get the lowest weight by a mask and are reported to the caller. The
+ * exponential has a relative error below 2e-7 for arguments down to
+ * s_PF_SIMD_EXP_MIN (checked against libm), below that it is 0. With the
+ * square root exact, a weight is within 2e-6 (relative) of the weight
+ * computed in single precision with libm.
+ *
+ * The kernel is selected at run time from the CPU features. Without SSE2
+ * (other architectures) no kernel is selected and the callers keep their
+ * scalar loops.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define PF_SIMD_X86
+#include <immintrin.h>
+#endif
+/* project libraries */
+#include "pf_simd.h"
+#include "rng.h"
+
+/* -- Defines -- */
+// Cephes single precision constants
+#define PF_SIMD_FOPI					1.27323954473516f // 4 / pi
+#define PF_SIMD_DP1						-0.78515625f // pi / 4 split in three parts
+#define PF_SIMD_DP2						-2.4187564849853515625e-4f
+#define PF_SIMD_DP3						-3.77489497744594108e-8f
+#define PF_SIMD_SIN_P0					-1.9515295891e-4f
+#define PF_SIMD_SIN_P1					8.3321608736e-3f
+#define PF_SIMD_SIN_P2					-1.6666654611e-1f
+#define PF_SIMD_COS_P0					2.443315711809948e-5f
+#define PF_SIMD_COS_P1					-1.388731625493765e-3f
+#define PF_SIMD_COS_P2					4.166664568298827e-2f
+#define PF_SIMD_SQRTHF					0.707106781186547524f
+#define PF_SIMD_LOG_P0					7.0376836292e-2f
+#define PF_SIMD_LOG_P1					-1.1514610310e-1f
+#define PF_SIMD_LOG_P2					1.1676998740e-1f
+#define PF_SIMD_LOG_P3					-1.2420140846e-1f
+#define PF_SIMD_LOG_P4					1.4249322787e-1f
+#define PF_SIMD_LOG_P5					-1.6668057665e-1f
+#define PF_SIMD_LOG_P6					2.0000714765e-1f
+#define PF_SIMD_LOG_P7					-2.4999993993e-1f
+#define PF_SIMD_LOG_P8					3.3333331174e-1f
+#define PF_SIMD_LOG_Q1					-2.12194440e-4f
+#define PF_SIMD_LOG_Q2					0.693359375f
+#define PF_SIMD_LOG2EF					1.44269504088896341f
+#define PF_SIMD_EXP_P0					1.9875691500e-4f
+#define PF_SIMD_EXP_P1					1.3981999507e-3f
+#define PF_SIMD_EXP_P2					8.3334519073e-3f
+#define PF_SIMD_EXP_P3					4.1665795894e-2f
+#define PF_SIMD_EXP_P4					1.6666665459e-1f
+#define PF_SIMD_EXP_P5					5.0000001201e-1f
+
+/* -- Global Variables -- */
+static int pf_simd_level = s_PF_SIMD_SCALAR; // Selected kernel
+
+/* -- Functions -- */
+
+/**
+ * Fill the uniform numbers of a motion update: u1 in (0, 1] for the radius
+ * and u2 in [0, 1) for the angle of the Box-Muller transform
+ * @param u Array of 2 * num numbers (u1 then u2)
+ * @param num Number of particles
+ * @return Void
+ */
+static void pf_simd_uniform(float *u, int num)
+{
+	int i;
+
+	rng_fill_float(s_RNG_STREAM_PF, u, 2 * num);
+	for(i = 0; i < num; i++)
+	{
+		u[i] = 1.0f - u[i];
+	}
+}
+
+/**
+ * Motion update of one particle (tail of the vector loops), the same model
+ * and noise as the vector kernels
+ * @return Void
+ */
+static void pf_simd_drive_one(	float *x,
+								float *y,
+								float *a,
+								float u1,
+								float u2,
+								int distance,
+								int angle,
+								float move_noise,
+								float turn_noise)
+{
+	float r = sqrtf(-2.0f * logf(u1));
+	float d;
+
+	if(angle != 0)
+	{
+		*a = fmodf(*a - (angle + turn_noise * r * cosf(2.0f * (float)M_PI * u2)) * (float)(M_PI / 180), (float)(M_PI * 2));
+	}
+	if(distance != 0)
+	{
+		d = distance + move_noise * r * sinf(2.0f * (float)M_PI * u2);
+		*x += cosf(*a) * d;
+		*y += sinf(*a) * d;
+	}
+}
+
+/**
+ * Tag likelihood of one particle (tail of the vector loops), the same as
+ * the vector kernels
+ * @return s_TRUE if the particle is outside the room, otherwise s_FALSE
+ */
+static int pf_simd_weight_one(	float x,
+								float y,
+								float *w,
+								float jitter,
+								float tx,
+								float ty,
+								float width,
+								float height,
+								float sigma)
+{
+	float t;
+
+	if(x > width || y > height || x < 0 || y < 0)
+	{
+		*w = s_PF_SIMD_WEIGHT_MIN;
+		return s_TRUE;
+	}
+
+	t = (sqrtf((x - tx) * (x - tx) + (y - ty) * (y - ty)) - jitter) / sigma;
+	t = -0.5f * t * t;
+	*w = t < s_PF_SIMD_EXP_MIN ? 0 : expf(t) / sqrtf((float)(M_PI * 2) * sigma * sigma);
+	if(*w == 0)
+		*w = s_PF_SIMD_WEIGHT_MIN;
+
+	return s_FALSE;
+}
+
+#ifdef PF_SIMD_X86
+
+/* -- SSE2 (4 lanes) -- */
+
+/**
+ * Natural logarithm of 4 positive numbers
+ * @param x Numbers
+ * @return Logarithms
+ */
+static __m128 pf_simd_log_sse2(__m128 x)
+{
+	__m128i e_i;
+	__m128 e, mask, tmp, z, y;
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	// Split into exponent and mantissa in [0.5, 1)
+	x = _mm_max_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x00800000)));
+	e_i = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(0x7f));
+	x = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(~0x7f800000)));
+	x = _mm_or_ps(x, _mm_set1_ps(0.5f));
+	e = _mm_add_ps(_mm_cvtepi32_ps(e_i), one);
+
+	// Mantissa in [sqrt(1/2), sqrt(2)), minus 1
+	mask = _mm_cmplt_ps(x, _mm_set1_ps(PF_SIMD_SQRTHF));
+	tmp = _mm_and_ps(x, mask);
+	x = _mm_sub_ps(x, one);
+	e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+	x = _mm_add_ps(x, tmp);
+
+	z = _mm_mul_ps(x, x);
+	y = _mm_set1_ps(PF_SIMD_LOG_P0);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P1));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P2));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P3));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P4));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P5));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P6));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P7));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_LOG_P8));
+	y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+	y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(PF_SIMD_LOG_Q1)));
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	x = _mm_add_ps(x, y);
+
+	return _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(PF_SIMD_LOG_Q2)));
+}
+
+/**
+ * Exponential of 4 numbers, 0 below s_PF_SIMD_EXP_MIN
+ * @param x Numbers (at most 88)
+ * @return Exponentials
+ */
+static __m128 pf_simd_exp_sse2(__m128 x)
+{
+	__m128i n;
+	__m128 fx, tmp, z, y, low;
+
+	low = _mm_cmplt_ps(x, _mm_set1_ps(s_PF_SIMD_EXP_MIN));
+	x = _mm_max_ps(x, _mm_set1_ps(s_PF_SIMD_EXP_MIN));
+
+	// x = n ln 2 + r, n = floor(x / ln 2 + 1/2)
+	fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(PF_SIMD_LOG2EF)), _mm_set1_ps(0.5f));
+	tmp = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	fx = _mm_sub_ps(tmp, _mm_and_ps(_mm_cmpgt_ps(tmp, fx), _mm_set1_ps(1.0f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(PF_SIMD_LOG_Q2)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(PF_SIMD_LOG_Q1)));
+
+	// e^r
+	z = _mm_mul_ps(x, x);
+	y = _mm_set1_ps(PF_SIMD_EXP_P0);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_EXP_P1));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_EXP_P2));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_EXP_P3));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_EXP_P4));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(PF_SIMD_EXP_P5));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.0f));
+
+	// Times 2^n
+	n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(0x7f)), 23);
+	y = _mm_mul_ps(y, _mm_castsi128_ps(n));
+
+	return _mm_andnot_ps(low, y);
+}
+
+/**
+ * Sine and cosine of 4 numbers (accurate for |x| below about 8000)
+ * @param x Angles (radians)
+ * @param s Sines
+ * @param c Cosines
+ * @return Void
+ */
+static void pf_simd_sincos_sse2(__m128 x, __m128 *s, __m128 *c)
+{
+	__m128i j, j_cos;
+	__m128 sign_sin, sign_cos, poly_mask, y, z, ys, yc;
+	const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+
+	sign_sin = _mm_and_ps(x, sign_mask);
+	x = _mm_andnot_ps(sign_mask, x);
+
+	// Octant, rounded up to even
+	j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(PF_SIMD_FOPI)));
+	j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+	y = _mm_cvtepi32_ps(j);
+
+	sign_sin = _mm_xor_ps(sign_sin, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29)));
+	j_cos = _mm_sub_epi32(j, _mm_set1_epi32(2));
+	sign_cos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(j_cos, _mm_set1_epi32(4)), 29));
+	poly_mask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+	// Reduce to [-pi/4, pi/4]
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(PF_SIMD_DP1)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(PF_SIMD_DP2)));
+	x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(PF_SIMD_DP3)));
+	z = _mm_mul_ps(x, x);
+
+	// Cosine polynomial
+	yc = _mm_set1_ps(PF_SIMD_COS_P0);
+	yc = _mm_add_ps(_mm_mul_ps(yc, z), _mm_set1_ps(PF_SIMD_COS_P1));
+	yc = _mm_add_ps(_mm_mul_ps(yc, z), _mm_set1_ps(PF_SIMD_COS_P2));
+	yc = _mm_mul_ps(_mm_mul_ps(yc, z), z);
+	yc = _mm_sub_ps(yc, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	yc = _mm_add_ps(yc, _mm_set1_ps(1.0f));
+
+	// Sine polynomial
+	ys = _mm_set1_ps(PF_SIMD_SIN_P0);
+	ys = _mm_add_ps(_mm_mul_ps(ys, z), _mm_set1_ps(PF_SIMD_SIN_P1));
+	ys = _mm_add_ps(_mm_mul_ps(ys, z), _mm_set1_ps(PF_SIMD_SIN_P2));
+	ys = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ys, z), x), x);
+
+	// Pick the polynomial for each octant and apply the signs
+	*s = _mm_xor_ps(_mm_or_ps(_mm_and_ps(poly_mask, ys), _mm_andnot_ps(poly_mask, yc)), sign_sin);
+	*c = _mm_xor_ps(_mm_or_ps(_mm_and_ps(poly_mask, yc), _mm_andnot_ps(poly_mask, ys)), sign_cos);
+}
+
+/**
+ * Motion update, 4 particles at a time
+ * @return Void
+ */
+static void pf_simd_drive_sse2(	float *x,
+								float *y,
+								float *a,
+								float *u,
+								int num,
+								int distance,
+								int angle,
+								float move_noise,
+								float turn_noise)
+{
+	int i;
+	__m128 r, s, c, va, vd;
+	const __m128 two_pi = _mm_set1_ps((float)(M_PI * 2));
+
+	for(i = 0; i + 4 <= num; i += 4)
+	{
+		// Two normal numbers per particle (Box-Muller)
+		r = _mm_sqrt_ps(_mm_mul_ps(_mm_set1_ps(-2.0f), pf_simd_log_sse2(_mm_loadu_ps(&u[i]))));
+		pf_simd_sincos_sse2(_mm_mul_ps(two_pi, _mm_loadu_ps(&u[num + i])), &s, &c);
+
+		va = _mm_load_ps(&a[i]);
+		if(angle != 0)
+		{
+			// a = fmod(a - (angle + noise) * pi / 180, 2 pi)
+			va = _mm_sub_ps(va, _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)angle), _mm_mul_ps(_mm_set1_ps(turn_noise), _mm_mul_ps(r, c))),
+					_mm_set1_ps((float)(M_PI / 180))));
+			va = _mm_sub_ps(va, _mm_mul_ps(two_pi, _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(va, two_pi)))));
+			_mm_store_ps(&a[i], va);
+		}
+		if(distance != 0)
+		{
+			vd = _mm_add_ps(_mm_set1_ps((float)distance), _mm_mul_ps(_mm_set1_ps(move_noise), _mm_mul_ps(r, s)));
+			pf_simd_sincos_sse2(va, &s, &c);
+			_mm_store_ps(&x[i], _mm_add_ps(_mm_load_ps(&x[i]), _mm_mul_ps(c, vd)));
+			_mm_store_ps(&y[i], _mm_add_ps(_mm_load_ps(&y[i]), _mm_mul_ps(s, vd)));
+		}
+	}
+	for(; i < num; i++)
+	{
+		pf_simd_drive_one(&x[i], &y[i], &a[i], u[i], u[num + i], distance, angle, move_noise, turn_noise);
+	}
+}
+
+/**
+ * Tag likelihood, 4 particles at a time
+ * @return Number of particles outside the room (their indices are in out)
+ */
+static int pf_simd_weight_tag_sse2(	const float *x,
+									const float *y,
+									float *w,
+									const float *u,
+									int *out,
+									int num,
+									float tx,
+									float ty,
+									float width,
+									float height,
+									float sigma)
+{
+	int i, n = 0, m;
+	__m128 vx, vy, dx, dy, t, p, outside, low;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 w_min = _mm_set1_ps(s_PF_SIMD_WEIGHT_MIN);
+	const __m128 norm = _mm_set1_ps(1.0f / sqrtf((float)(M_PI * 2) * sigma * sigma));
+
+	for(i = 0; i + 4 <= num; i += 4)
+	{
+		vx = _mm_load_ps(&x[i]);
+		vy = _mm_load_ps(&y[i]);
+		outside = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(vx, _mm_set1_ps(width)), _mm_cmpgt_ps(vy, _mm_set1_ps(height))),
+							_mm_or_ps(_mm_cmplt_ps(vx, zero), _mm_cmplt_ps(vy, zero)));
+
+		// Gaussian of the distance to the tag (minus the jitter)
+		dx = _mm_sub_ps(vx, _mm_set1_ps(tx));
+		dy = _mm_sub_ps(vy, _mm_set1_ps(ty));
+		t = _mm_sub_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))), _mm_loadu_ps(&u[i]));
+		t = _mm_div_ps(t, _mm_set1_ps(sigma));
+		p = _mm_mul_ps(pf_simd_exp_sse2(_mm_mul_ps(_mm_set1_ps(-0.5f), _mm_mul_ps(t, t))), norm);
+
+		// Lowest weight if the likelihood is 0 or the particle is outside
+		low = _mm_or_ps(outside, _mm_cmpeq_ps(p, zero));
+		_mm_store_ps(&w[i], _mm_or_ps(_mm_and_ps(low, w_min), _mm_andnot_ps(low, p)));
+
+		// Report the particles outside (rarely any)
+		m = _mm_movemask_ps(outside);
+		while(m)
+		{
+			out[n++] = i + __builtin_ctz(m);
+			m &= m - 1;
+		}
+	}
+	for(; i < num; i++)
+	{
+		if(pf_simd_weight_one(x[i], y[i], &w[i], u[i], tx, ty, width, height, sigma))
+			out[n++] = i;
+	}
+
+	return n;
+}
+
+/* -- AVX2 (8 lanes) -- */
+
+/**
+ * Natural logarithm of 8 positive numbers
+ * @param x Numbers
+ * @return Logarithms
+ */
+__attribute__((target("avx2,fma")))
+static __m256 pf_simd_log_avx2(__m256 x)
+{
+	__m256i e_i;
+	__m256 e, mask, tmp, z, y;
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	// Split into exponent and mantissa in [0.5, 1)
+	x = _mm256_max_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x00800000)));
+	e_i = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(x), 23), _mm256_set1_epi32(0x7f));
+	x = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(~0x7f800000)));
+	x = _mm256_or_ps(x, _mm256_set1_ps(0.5f));
+	e = _mm256_add_ps(_mm256_cvtepi32_ps(e_i), one);
+
+	// Mantissa in [sqrt(1/2), sqrt(2)), minus 1
+	mask = _mm256_cmp_ps(x, _mm256_set1_ps(PF_SIMD_SQRTHF), _CMP_LT_OQ);
+	tmp = _mm256_and_ps(x, mask);
+	x = _mm256_sub_ps(x, one);
+	e = _mm256_sub_ps(e, _mm256_and_ps(one, mask));
+	x = _mm256_add_ps(x, tmp);
+
+	z = _mm256_mul_ps(x, x);
+	y = _mm256_set1_ps(PF_SIMD_LOG_P0);
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P1));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P2));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P3));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P4));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P5));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P6));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P7));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_LOG_P8));
+	y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+	y = _mm256_fmadd_ps(e, _mm256_set1_ps(PF_SIMD_LOG_Q1), y);
+	y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+	x = _mm256_add_ps(x, y);
+
+	return _mm256_fmadd_ps(e, _mm256_set1_ps(PF_SIMD_LOG_Q2), x);
+}
+
+/**
+ * Exponential of 8 numbers, 0 below s_PF_SIMD_EXP_MIN
+ * @param x Numbers (at most 88)
+ * @return Exponentials
+ */
+__attribute__((target("avx2,fma")))
+static __m256 pf_simd_exp_avx2(__m256 x)
+{
+	__m256i n;
+	__m256 fx, z, y, low;
+
+	low = _mm256_cmp_ps(x, _mm256_set1_ps(s_PF_SIMD_EXP_MIN), _CMP_LT_OQ);
+	x = _mm256_max_ps(x, _mm256_set1_ps(s_PF_SIMD_EXP_MIN));
+
+	// x = n ln 2 + r, n = floor(x / ln 2 + 1/2)
+	fx = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(PF_SIMD_LOG2EF), _mm256_set1_ps(0.5f)));
+	x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(PF_SIMD_LOG_Q2), x);
+	x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(PF_SIMD_LOG_Q1), x);
+
+	// e^r
+	z = _mm256_mul_ps(x, x);
+	y = _mm256_set1_ps(PF_SIMD_EXP_P0);
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_EXP_P1));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_EXP_P2));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_EXP_P3));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_EXP_P4));
+	y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(PF_SIMD_EXP_P5));
+	y = _mm256_add_ps(_mm256_fmadd_ps(y, z, x), _mm256_set1_ps(1.0f));
+
+	// Times 2^n
+	n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(0x7f)), 23);
+	y = _mm256_mul_ps(y, _mm256_castsi256_ps(n));
+
+	return _mm256_andnot_ps(low, y);
+}
+
+/**
+ * Sine and cosine of 8 numbers (accurate for |x| below about 8000)
+ * @param x Angles (radians)
+ * @param s Sines
+ * @param c Cosines
+ * @return Void
+ */
+__attribute__((target("avx2,fma")))
+static void pf_simd_sincos_avx2(__m256 x, __m256 *s, __m256 *c)
+{
+	__m256i j, j_cos;
+	__m256 sign_sin, sign_cos, poly_mask, y, z, ys, yc;
+	const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+
+	sign_sin = _mm256_and_ps(x, sign_mask);
+	x = _mm256_andnot_ps(sign_mask, x);
+
+	// Octant, rounded up to even
+	j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(PF_SIMD_FOPI)));
+	j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+	y = _mm256_cvtepi32_ps(j);
+
+	sign_sin = _mm256_xor_ps(sign_sin, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29)));
+	j_cos = _mm256_sub_epi32(j, _mm256_set1_epi32(2));
+	sign_cos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(j_cos, _mm256_set1_epi32(4)), 29));
+	poly_mask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+
+	// Reduce to [-pi/4, pi/4]
+	x = _mm256_fmadd_ps(y, _mm256_set1_ps(PF_SIMD_DP1), x);
+	x = _mm256_fmadd_ps(y, _mm256_set1_ps(PF_SIMD_DP2), x);
+	x = _mm256_fmadd_ps(y, _mm256_set1_ps(PF_SIMD_DP3), x);
+	z = _mm256_mul_ps(x, x);
+
+	// Cosine polynomial
+	yc = _mm256_set1_ps(PF_SIMD_COS_P0);
+	yc = _mm256_fmadd_ps(yc, z, _mm256_set1_ps(PF_SIMD_COS_P1));
+	yc = _mm256_fmadd_ps(yc, z, _mm256_set1_ps(PF_SIMD_COS_P2));
+	yc = _mm256_mul_ps(_mm256_mul_ps(yc, z), z);
+	yc = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), yc);
+	yc = _mm256_add_ps(yc, _mm256_set1_ps(1.0f));
+
+	// Sine polynomial
+	ys = _mm256_set1_ps(PF_SIMD_SIN_P0);
+	ys = _mm256_fmadd_ps(ys, z, _mm256_set1_ps(PF_SIMD_SIN_P1));
+	ys = _mm256_fmadd_ps(ys, z, _mm256_set1_ps(PF_SIMD_SIN_P2));
+	ys = _mm256_fmadd_ps(_mm256_mul_ps(ys, z), x, x);
+
+	// Pick the polynomial for each octant and apply the signs
+	*s = _mm256_xor_ps(_mm256_blendv_ps(yc, ys, poly_mask), sign_sin);
+	*c = _mm256_xor_ps(_mm256_blendv_ps(ys, yc, poly_mask), sign_cos);
+}
+
+/**
+ * Motion update, 8 particles at a time
+ * @return Void
+ */
+__attribute__((target("avx2,fma")))
+static void pf_simd_drive_avx2(	float *x,
+								float *y,
+								float *a,
+								float *u,
+								int num,
+								int distance,
+								int angle,
+								float move_noise,
+								float turn_noise)
+{
+	int i;
+	__m256 r, s, c, va, vd;
+	const __m256 two_pi = _mm256_set1_ps((float)(M_PI * 2));
+
+	for(i = 0; i + 8 <= num; i += 8)
+	{
+		// Two normal numbers per particle (Box-Muller)
+		r = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_set1_ps(-2.0f), pf_simd_log_avx2(_mm256_loadu_ps(&u[i]))));
+		pf_simd_sincos_avx2(_mm256_mul_ps(two_pi, _mm256_loadu_ps(&u[num + i])), &s, &c);
+
+		va = _mm256_load_ps(&a[i]);
+		if(angle != 0)
+		{
+			// a = fmod(a - (angle + noise) * pi / 180, 2 pi)
+			va = _mm256_fnmadd_ps(_mm256_fmadd_ps(_mm256_set1_ps(turn_noise), _mm256_mul_ps(r, c), _mm256_set1_ps((float)angle)),
+					_mm256_set1_ps((float)(M_PI / 180)), va);
+			va = _mm256_fnmadd_ps(two_pi, _mm256_round_ps(_mm256_div_ps(va, two_pi), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), va);
+			_mm256_store_ps(&a[i], va);
+		}
+		if(distance != 0)
+		{
+			vd = _mm256_fmadd_ps(_mm256_set1_ps(move_noise), _mm256_mul_ps(r, s), _mm256_set1_ps((float)distance));
+			pf_simd_sincos_avx2(va, &s, &c);
+			_mm256_store_ps(&x[i], _mm256_fmadd_ps(c, vd, _mm256_load_ps(&x[i])));
+			_mm256_store_ps(&y[i], _mm256_fmadd_ps(s, vd, _mm256_load_ps(&y[i])));
+		}
+	}
+	for(; i < num; i++)
+	{
+		pf_simd_drive_one(&x[i], &y[i], &a[i], u[i], u[num + i], distance, angle, move_noise, turn_noise);
+	}
+}
+
+/**
+ * Tag likelihood, 8 particles at a time
+ * @return Number of particles outside the room (their indices are in out)
+ */
+__attribute__((target("avx2,fma")))
+static int pf_simd_weight_tag_avx2(	const float *x,
+									const float *y,
+									float *w,
+									const float *u,
+									int *out,
+									int num,
+									float tx,
+									float ty,
+									float width,
+									float height,
+									float sigma)
+{
+	int i, n = 0, m;
+	__m256 vx, vy, dx, dy, t, p, outside, low;
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 norm = _mm256_set1_ps(1.0f / sqrtf((float)(M_PI * 2) * sigma * sigma));
+
+	for(i = 0; i + 8 <= num; i += 8)
+	{
+		vx = _mm256_load_ps(&x[i]);
+		vy = _mm256_load_ps(&y[i]);
+		outside = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(vx, _mm256_set1_ps(width), _CMP_GT_OQ),
+											_mm256_cmp_ps(vy, _mm256_set1_ps(height), _CMP_GT_OQ)),
+								_mm256_or_ps(_mm256_cmp_ps(vx, zero, _CMP_LT_OQ),
+											_mm256_cmp_ps(vy, zero, _CMP_LT_OQ)));
+
+		// Gaussian of the distance to the tag (minus the jitter)
+		dx = _mm256_sub_ps(vx, _mm256_set1_ps(tx));
+		dy = _mm256_sub_ps(vy, _mm256_set1_ps(ty));
+		t = _mm256_sub_ps(_mm256_sqrt_ps(_mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy))), _mm256_loadu_ps(&u[i]));
+		t = _mm256_div_ps(t, _mm256_set1_ps(sigma));
+		p = _mm256_mul_ps(pf_simd_exp_avx2(_mm256_mul_ps(_mm256_set1_ps(-0.5f), _mm256_mul_ps(t, t))), norm);
+
+		// Lowest weight if the likelihood is 0 or the particle is outside
+		low = _mm256_or_ps(outside, _mm256_cmp_ps(p, zero, _CMP_EQ_OQ));
+		_mm256_store_ps(&w[i], _mm256_blendv_ps(p, _mm256_set1_ps(s_PF_SIMD_WEIGHT_MIN), low));
+
+		// Report the particles outside (rarely any)
+		m = _mm256_movemask_ps(outside);
+		while(m)
+		{
+			out[n++] = i + __builtin_ctz(m);
+			m &= m - 1;
+		}
+	}
+	for(; i < num; i++)
+	{
+		if(pf_simd_weight_one(x[i], y[i], &w[i], u[i], tx, ty, width, height, sigma))
+			out[n++] = i;
+	}
+
+	return n;
+}
+
+#endif /* PF_SIMD_X86 */
+
+/**
+ * Select the widest kernel the CPU supports
+ * @param enable If 0, no kernel is selected (scalar loops only)
+ * @return Selected kernel (s_PF_SIMD_*)
+ */
+int pf_simd_init(int enable)
+{
+	pf_simd_level = s_PF_SIMD_SCALAR;
+#ifdef PF_SIMD_X86
+	if(enable)
+	{
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			pf_simd_level = s_PF_SIMD_AVX2;
+		else if(__builtin_cpu_supports("sse2"))
+			pf_simd_level = s_PF_SIMD_SSE2;
+	}
+#else
+	(void)enable;
+#endif
+
+	return pf_simd_level;
+}
+
+/**
+ * Get name of the selected kernel
+ * @return Kernel name
+ */
+const char *pf_simd_name(void)
+{
+	switch(pf_simd_level)
+	{
+		case s_PF_SIMD_AVX2 :
+			return "avx2";
+		case s_PF_SIMD_SSE2 :
+			return "sse2";
+		default :
+			return "scalar";
+	}
+}
+
+/**
+ * Motion update of all particles with the selected kernel
+ * @param x X coordinates (aligned to 32 bytes)
+ * @param y Y coordinates (aligned to 32 bytes)
+ * @param a Heading directions (aligned to 32 bytes)
+ * @param u Scratch array for the noise (2 * num)
+ * @param num Number of particles
+ * @param distance Distance traveled (mm)
+ * @param angle Angle change (Degrees)
+ * @param move_noise Error created during forward or backward motion (mm)
+ * @param turn_noise Error created during turning (Degrees)
+ * @return s_OK, s_ERROR if no kernel is selected (use the scalar loop)
+ */
+int pf_simd_drive(	float *x,
+					float *y,
+					float *a,
+					float *u,
+					int num,
+					int distance,
+					int angle,
+					float move_noise,
+					float turn_noise)
+{
+	if(pf_simd_level == s_PF_SIMD_SCALAR)
+		return s_ERROR;
+
+	if(distance == 0 && angle == 0)
+		return s_OK;
+	pf_simd_uniform(u, num);
+
+#ifdef PF_SIMD_X86
+	if(pf_simd_level == s_PF_SIMD_AVX2)
+		pf_simd_drive_avx2(x, y, a, u, num, distance, angle, move_noise, turn_noise);
+	else
+		pf_simd_drive_sse2(x, y, a, u, num, distance, angle, move_noise, turn_noise);
+#endif
+
+	return s_OK;
+}
+
+/**
+ * Tag likelihood of all particles with the selected kernel: the Gaussian of
+ * the distance to the read tag, minus a random jitter below jitter_max
+ * (as general_gaussian is used by robot_eval_tag). Particles outside the
+ * room get the lowest weight and their indices are returned in out
+ * @param x X coordinates (aligned to 32 bytes)
+ * @param y Y coordinates (aligned to 32 bytes)
+ * @param w Weights (aligned to 32 bytes)
+ * @param u Scratch array for the jitter (num)
+ * @param out Indices of the particles outside the room (num)
+ * @param num Number of particles
+ * @param tx X coordinate of the tag (mm)
+ * @param ty Y coordinate of the tag (mm)
+ * @param width Room width (mm)
+ * @param height Room height (mm)
+ * @param sigma Error of tag read (mm)
+ * @param jitter_max Jitter range (mm)
+ * @return Number of particles outside the room, s_ERROR if no kernel is selected (use the scalar loop)
+ */
+int pf_simd_weight_tag(	const float *x,
+						const float *y,
+						float *w,
+						float *u,
+						int *out,
+						int num,
+						float tx,
+						float ty,
+						float width,
+						float height,
+						float sigma,
+						int jitter_max)
+{
+	int i;
+
+	if(pf_simd_level == s_PF_SIMD_SCALAR)
+		return s_ERROR;
+
+	for(i = 0; i < num; i++)
+	{
+		u[i] = (float)rng_int(s_RNG_STREAM_PF, jitter_max);
+	}
+
+#ifdef PF_SIMD_X86
+	if(pf_simd_level == s_PF_SIMD_AVX2)
+		return pf_simd_weight_tag_avx2(x, y, w, u, out, num, tx, ty, width, height, sigma);
+	else
+		return pf_simd_weight_tag_sse2(x, y, w, u, out, num, tx, ty, width, height, sigma);
+#else
+	return s_ERROR;
+#endif
+}
@@ -0,0 +1,50 @@
+/**
+ * @file	pf_simd.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Vectorised particle filter kernels header file.
+ */
+
+#ifndef __PF_SIMD_H
+#define __PF_SIMD_H
+
+/* -- Includes -- */
+/* project libraries */
+#include "def.h"
+
+/* -- Constants -- */
+#define s_PF_SIMD_SCALAR				0 // No vector kernel, the callers use their scalar loops
+#define s_PF_SIMD_SSE2					1 // 4 particles per instruction
+#define s_PF_SIMD_AVX2					2 // 8 particles per instruction
+#define s_PF_SIMD_EXP_MIN				-87.0f // Smallest argument of the exponential, below it the result is 0
+#define s_PF_SIMD_WEIGHT_MIN			0.00001f // Weight of particles outside the room or with a likelihood of 0
+
+/* -- Function Prototypes -- */
+int pf_simd_init(int enable); // Select the widest kernel the CPU supports (s_PF_SIMD_*)
+const char *pf_simd_name(void); // Name of the selected kernel
+int pf_simd_drive(	float *x,
+					float *y,
+					float *a,
+					float *u,
+					int num,
+					int distance,
+					int angle,
+					float move_noise,
+					float turn_noise); // Motion update of all particles
+int pf_simd_weight_tag(	const float *x,
+						const float *y,
+						float *w,
+						float *u,
+						int *out,
+						int num,
+						float tx,
+						float ty,
+						float width,
+						float height,
+						float sigma,
+						int jitter_max); // Tag likelihood of all particles
+
+#endif /* __PF_SIMD_H */
@@ -21,6 +21,8 @@
 #include "general.h"
 #include "def.h"
 #include "debug.h"
+#include "rng.h"
+#include "timelib.h"
 
 /* -- Defines -- */
 
@@ -80,6 +82,8 @@ pheromone_t *pheromone_init(enviroment_t *env,
 		ph->eval_cells++;
 	// Make smell stencil
 	pheromone_make_stencil(&ph->eval_stencil, ph->eval_cells);
+	// Evaluate every cell of the stencil
+	ph->eval_step = 1;
 
 	// How many cells fit in the pheromone stencil
 	ph->pheromone_cells = ceil((float)(pheromone_radius * 2) / (float)width);
@@ -98,6 +102,10 @@ pheromone_t *pheromone_init(enviroment_t *env,
     debug_printf("map: %d, %d\n",ph->x_cells, ph->y_cells);
     debug_printf("sec: %d, %d, %d, %d\n", ph->y_cells, ph->sector_size, ph->sector_count, ph->sector_size_last);
 
+	// Sectors of the pipelined extraction, refreshed a few at a time
+	ph->sectors = (pheromone_map_sector_t *)malloc(ph->sector_count * sizeof(pheromone_map_sector_t));
+	ph->extract_next = 0;
+
 	return ph;
 }
 
@@ -132,6 +140,9 @@ void pheromone_destroy(pheromone_t *ph)
 	}
 	free(ph->pheromone_stencil);
 
+	// Free sectors of the pipelined extraction
+	free(ph->sectors);
+
 	// Free pheromone structure
 	free(ph);
 
@@ -202,7 +213,7 @@ void pheromone_put(pheromone_t *ph, int x, int y)
 				if((cx + i) >= 0 && (cy + j) >= 0 && (cx + i) < ph->x_cells && (cy + j) < ph->y_cells)
 				{
 					// Set pheromone with its timestamp
-					ph->map[cx + i][cy + j] = time(NULL) / ph->lifetime;
+					ph->map[cx + i][cy + j] = timelib_time() / ph->lifetime;
 					//printf("pheromone: %d, %d, %d\n", cx + i, cy + j, ph->map[cx + i][cy + j]);
 				}
 			}
@@ -240,10 +251,11 @@ int pheromone_eval(pheromone_t *ph, robot_t *robot)
 		x = cos(robot->a + a[k]) * ((ph->pheromone_radius + ph->eval_radius) / ph->width) + (robot->x - ph->eval_radius) / ph->width;
 		y = sin(robot->a + a[k]) * ((ph->pheromone_radius + ph->eval_radius) / ph->width) + (robot->y - ph->eval_radius) / ph->width;
 
-		// Applay smell stencil and evaluate smell in area
-		for(i = 0; i < ph->eval_cells; i++)
+		// Applay smell stencil and evaluate smell in area (every eval_step-th
+		// cell in both directions, the same cells in all 5 areas)
+		for(i = ph->eval_step / 2; i < ph->eval_cells; i += ph->eval_step)
 		{
-			for(j = 0; j < ph->eval_cells; j++)
+			for(j = ph->eval_step / 2; j < ph->eval_cells; j += ph->eval_step)
 			{
 				// Check if stencill element is full
 				if(ph->eval_stencil[i][j] != 0)
@@ -251,7 +263,7 @@ int pheromone_eval(pheromone_t *ph, robot_t *robot)
 					// Check if in range
 					if((x + i) >= 0 && (y + j) >= 0 && (x + i) < ph->x_cells && (y + j) < ph->y_cells)
 					{
-						t = ((time(NULL) / ph->lifetime) - ph->map[x + i][y + j]);
+						t = ((timelib_time() / ph->lifetime) - ph->map[x + i][y + j]);
 						if(t > 255) {
 							t = 255;
 						}
@@ -285,7 +297,7 @@ int pheromone_eval(pheromone_t *ph, robot_t *robot)
 		}
 		else if(p[k] == max)
 		{
-			if((rand() % 10) > 5)
+			if(rng_int(s_RNG_STREAM_NAVIGATE, 10) > 5)
 			{
 				max_i = k;
 			}
@@ -296,7 +308,7 @@ int pheromone_eval(pheromone_t *ph, robot_t *robot)
 
 	if(p[0] == p[1] && p[0] == p[2]  && p[0] == p[3]  && p[0] == p[4])
 	{
-		return (rand() % 5);
+		return rng_int(s_RNG_STREAM_NAVIGATE, 5);
 	}
 	else
 	{
@@ -364,35 +376,30 @@ void pheromone_map_update(pheromone_t *ph, pheromone_map_sector_t *phms)
 }
 
 /**
- * Extract array of pheromone map sectors
+ * Extract one pheromone map sector
  * @param ph Pointer to pheromone structure
- * @return Pointer to array of pheromone map sector structures
+ * @param phms Pointer to pheromone map sector structure to fill in
+ * @param num Sector number
+ * @return Void
  */
-pheromone_map_sector_t **pheromone_map_extract(pheromone_t *ph)
+void pheromone_map_extract_sector(pheromone_t *ph, pheromone_map_sector_t *phms, int num)
 {
 	// Local variables
-	int i, j, x = 0, y = 0;
+	int i, j, y = 0;
 	int t, t_curr;
 	unsigned char cell;
 
-	// Allocate memory for pheromone map sector structures
-	pheromone_map_sector_t **phms = (pheromone_map_sector_t **)malloc(ph->sector_count * sizeof(pheromone_map_sector_t *));
-	for(i = 0; i < ph->sector_count; i++)
-	{
-		phms[i] = (pheromone_map_sector_t *)malloc(sizeof(pheromone_map_sector_t));
-	}
-
 	// Get current timestamp
-	t_curr = time(NULL) / ph->lifetime;
+	t_curr = timelib_time() / ph->lifetime;
 
-	// Save data about first sector
-	phms[x]->num = x;
-	phms[x]->size = ph->y_cells * ph->sector_size;
-	phms[x]->timestamp = t_curr;
-	memset(phms[x]->data, 0xFF, ph->sector_max_size);
+	// Save data about sector
+	phms->num = num;
+	phms->size = ph->y_cells * ph->sector_size;
+	phms->timestamp = t_curr;
+	memset(phms->data, 0xFF, ph->sector_max_size);
 
-	// Loop through map data and fill in the sectors
-	for(i = 0; i < ph->x_cells; i++)
+	// Loop through the map columns of the sector (the last sector may not be full)
+	for(i = num * ph->sector_size; i < (num + 1) * ph->sector_size && i < ph->x_cells; i++)
 	{
 		for(j = 0; j < ph->y_cells; j++)
 		{
@@ -413,33 +420,60 @@ pheromone_map_sector_t **pheromone_map_extract(pheromone_t *ph)
 			}
 
 			// Save cell value in sector
-			phms[x]->data[y] = cell;
+			phms->data[y++] = cell;
+		}
+	}
+}
 
-			// Increase sector data counter
-			y++;
-			// Check if sector is full. If yes then ...
-			if(y >= (ph->y_cells * ph->sector_size))
-			{
-				// Increase sector number
-				x++;
-				// Reset sector data counter
-				y = 0;
+/**
+ * Extract array of pheromone map sectors
+ * @param ph Pointer to pheromone structure
+ * @return Pointer to array of pheromone map sector structures
+ */
+pheromone_map_sector_t **pheromone_map_extract(pheromone_t *ph)
+{
+	// Local variables
+	int i;
 
-				// Save data about new sector
-				if(x < ph->sector_count)
-				{
-					phms[x]->num = x;
-					phms[x]->size = ph->y_cells * ph->sector_size;
-					phms[x]->timestamp = t_curr;
-					memset(phms[x]->data, 0xFF, ph->sector_max_size);
-				}
-			}
-		}
+	// Allocate memory for pheromone map sector structures
+	pheromone_map_sector_t **phms = (pheromone_map_sector_t **)malloc(ph->sector_count * sizeof(pheromone_map_sector_t *));
+	for(i = 0; i < ph->sector_count; i++)
+	{
+		phms[i] = (pheromone_map_sector_t *)malloc(sizeof(pheromone_map_sector_t));
+		pheromone_map_extract_sector(ph, phms[i], i);
 	}
 
 	return phms;
 }
 
+/**
+ * Refresh the next sectors of the pipelined extraction (ph->sectors) in
+ * round-robin order. A pass over the map is spread over several calls
+ * @param ph Pointer to pheromone structure
+ * @param num Number of sectors to refresh
+ * @return s_TRUE if the last sector of the map was refreshed (the pass is complete), otherwise s_FALSE
+ */
+int pheromone_map_extract_step(pheromone_t *ph, int num)
+{
+	// Local variables
+	int i;
+
+	for(i = 0; i < num && ph->extract_next < ph->sector_count; i++)
+	{
+		pheromone_map_extract_sector(ph, &ph->sectors[ph->extract_next], ph->extract_next);
+		ph->extract_next++;
+	}
+
+	// Start the next pass at the first sector
+	if(ph->extract_next >= ph->sector_count)
+	{
+		ph->extract_next = 0;
+		return s_TRUE;
+	}
+
+	return s_FALSE;
+}
+
 /**
  * Destroy (free memory) array of pheromone map sectors
  * @param ph Pointer to pheromone structure
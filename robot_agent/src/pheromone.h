@@ -36,6 +36,7 @@ typedef struct s_PHEROMONE_STRUCT
 	int y_cells; // NUmber of grid cells in y direction
 
 	int eval_cells; // Number of cells in x and y direction in smell stencil (area is square)
+	int eval_step; // Stride through the smell stencil (1 - every cell, larger is coarser and faster)
 	int pheromone_cells; // Number of cells in x and y direction in pheromone stencil (area is square)
 
 	int lifetime; // Lifetime of a pheromone
@@ -50,6 +51,9 @@ typedef struct s_PHEROMONE_STRUCT
 	int sector_size;
 	int sector_size_last;
 
+	struct s_PHEROMONE_MAP_SECTOR_STRUCT *sectors; // Sectors of the pipelined extraction (sector_count)
+	int extract_next; // Next sector the pipelined extraction refreshes
+
 } pheromone_t;
 
 /**
@@ -97,6 +101,8 @@ int pheromone_eval(pheromone_t *ph, robot_t *robot); // Evaluate smell in pherom
 
 void pheromone_map_update(pheromone_t *ph, pheromone_map_sector_t *phms); // Update pheromone map
 pheromone_map_sector_t **pheromone_map_extract(pheromone_t *ph); // Extract array of pheromone map sectors
+void pheromone_map_extract_sector(pheromone_t *ph, pheromone_map_sector_t *phms, int num); // Extract one pheromone map sector
+int pheromone_map_extract_step(pheromone_t *ph, int num); // Refresh next sectors of the pipelined extraction
 void pheromone_map_destroy(pheromone_t *ph, pheromone_map_sector_t **phms); // Destroy (free memory) array of pheromone map sectors
 
  #endif /* __PHEROMONE_H */
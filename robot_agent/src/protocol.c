@@ -56,7 +56,7 @@ int protocol_encode(char *udp_packet,
 	*len = 0;
 
 
-    int timestamp = (long long)timelib_unix_timestamp() % 60000;
+    int timestamp = (int)(timelib_wall_ms() % 60000);
 
 	// Encode Reciever ID, Sender ID, Type, Timestamp, SequenceNumber, SequenceID, SequenceLastID
 	*len += sprintf(udp_packet,"%d,%d,%d,%c,%d,%d,%d,%d",recv_id, send_id, send_team, type,timestamp,seqno,seqid,seq_lid);
@@ -157,6 +157,42 @@ int protocol_encode(char *udp_packet,
 	return s_OK;
 }
 
+/**
+ * Decode the header (receiver, sender, team and packet type) of a string
+ * received from UDP, without changing the string and without dropping
+ * packets of other teams
+ * @param packet
+ * @param udp_packet
+ * @return s_OK if successful, s_ERROR if the header is malformed
+ */
+int protocol_decode_header(protocol_t *packet, const char *udp_packet)
+{
+	const char *pch = udp_packet;
+	char *end_ptr;
+
+	// Save Reciever ID
+	packet->recv_id = strtol(pch, &end_ptr, 10);
+	if(end_ptr == pch || *end_ptr != ',')
+		return s_ERROR;
+	// Save Sender ID
+	pch = end_ptr + 1;
+	packet->send_id = strtol(pch, &end_ptr, 10);
+	if(end_ptr == pch || *end_ptr != ',')
+		return s_ERROR;
+	// Save Sender Team
+	pch = end_ptr + 1;
+	packet->send_team = strtol(pch, &end_ptr, 10);
+	if(end_ptr == pch || *end_ptr != ',')
+		return s_ERROR;
+	// Save Packet type
+	pch = end_ptr + 1;
+	if(*pch == '\0' || *pch == ',')
+		return s_ERROR;
+	packet->type = *pch;
+
+	return s_OK;
+}
+
 /**
  * Decode string received from UDP into interpretable data
  * @param packet
@@ -172,26 +208,22 @@ int protocol_decode(protocol_t *packet, char *udp_packet, int len, int robot_id,
 	char *end_ptr, *pch;
 
 	// Process data into struct
-	// Save Reciever ID
-	pch = strtok(udp_packet, ",");
-	packet->recv_id = strtol(pch, &end_ptr, 10);
-	// Save Sender ID
-	pch = strtok(NULL, ",");
-	packet->send_id = strtol(pch, &end_ptr, 10);
+	// Save Reciever ID, Sender ID, Sender Team and Packet type
+	if(protocol_decode_header(packet, udp_packet) == s_ERROR)
+		return s_ERROR;
 	// Check if it is not sent by yourself. If yes, drop.
 	if(packet->send_id == robot_id)
 		return s_ERROR;
-	// Save Sender Team
-	pch = strtok(NULL, ",");
-	packet->send_team = strtol(pch, &end_ptr, 10);
 	// Check if it is not sent by other team. If yes, drop.
 	// Or if send_team = 0, then ignore team ID
 	if(packet->send_team != robot_team && robot_team != 0)
 		return s_ERROR;
 
-	// Save Packet type
-	pch = strtok(NULL, ",");
-	memcpy(&packet->type, pch, 1);
+	// Skip the header fields
+	strtok(udp_packet, ",");
+	strtok(NULL, ",");
+	strtok(NULL, ",");
+	strtok(NULL, ",");
 
     //Save packet timestamp
     pch = strtok(NULL, ",");
@@ -58,6 +58,8 @@ int protocol_encode(char *udp_packet,
 					int data_type,
 					void *data); // Encode data structure into string to be sent through UDP
 
+/* Decode the header (sender and type) of a udp packet, packets of other teams included */
+int protocol_decode_header(protocol_t *packet, const char *udp_packet);
 /* Decode the data structure contanied in the udp packet */
 int protocol_decode(protocol_t *packet, char *udp_packet, int len, int robot_id, int robot_team);
 
@@ -17,11 +17,13 @@
 #include <unistd.h>  /* UNIX standard function definitions */
 #include <sys/time.h>
 #include <sys/select.h>
+#include <signal.h>
 /* project libraries */
 #include "config.h"
 #include "def.h"
 #include "serialport.h"
 #include "rfid.h"
+#include "trace.h"
 
 /* -- Defines -- */
 
@@ -41,6 +43,10 @@ rfid_t *rfid_open(char *device_path)
 	rfids->sps = serialport_open(device_path);
 	// Configure serial port
 	serialport_config(rfids->sps, 2400);
+	// No reader thread yet, tags are read by the caller
+	rfids->reader_run = s_FALSE;
+	rfids->reader_polled = s_FALSE;
+	rfids->frame_len = 11;
 
 	return rfids;
 }
@@ -54,6 +60,9 @@ int rfid_close(rfid_t *rfids)
 {
 	int res;
 
+	// Stop reader thread before the port goes away
+	rfid_reader_stop(rfids);
+
 	// Close serial port
 	res = serialport_close(rfids->sps);
 	// Free memory
@@ -142,6 +151,35 @@ int rfid_read(rfid_t *rfids)
 	FD_ZERO(&infds2);
 	FD_SET(rfids->sps->descriptor, &infds2);
 
+	trace_event(s_TRACE_EVENT_RFID_BEGIN, 0, 0);
+
+	// The reader thread or the event loop parses the tags, only check if a new one was published
+	if(__atomic_load_n(&rfids->reader_run, __ATOMIC_ACQUIRE) || rfids->reader_polled)
+	{
+		uint32_t version = slot_read(&rfids->reader_slot, buffer, 11);
+		if(version != rfids->reader_version)
+		{
+			rfids->reader_version = version;
+			strncpy(rfids->id, buffer, 11);
+			strncpy(rfids->last_id, buffer, 11);
+			trace_event(s_TRACE_EVENT_RFID_END, 0, 0);
+		}
+		else
+		{
+			strncpy(rfids->id, s_CONFIG_RFID_EMPTY_TAG, 11);
+			trace_event(s_TRACE_EVENT_RFID_END, 0, -1);
+		}
+		return 0;
+	}
+
+	// No device, do not wait for the timeout
+	if(rfids->sps->descriptor < 0)
+	{
+		strncpy(rfids->id, s_CONFIG_RFID_EMPTY_TAG, 11);
+		trace_event(s_TRACE_EVENT_RFID_END, 0, -1);
+		return 0;
+	}
+
 	// Read characters into buffer until we get a CR or NL
 	bufptr = buffer;
 
@@ -166,6 +204,7 @@ int rfid_read(rfid_t *rfids)
 					// Flush input buffer
 					//printf("FLUSHED: %d\n", serialport_flush_input(rfids->sps));
 
+					trace_event(s_TRACE_EVENT_RFID_END, 0, 0);
 					return 0;
 				}
 			}
@@ -192,6 +231,155 @@ int rfid_read(rfid_t *rfids)
 
 	//!!! Check errors
 
+	trace_event(s_TRACE_EVENT_RFID_END, 0, -1);
 	return 0;
 }
 
+/**
+ * Parse tag frames ("NL" + 10 characters + "CR") and publish every complete tag id
+ * @param rfids Pointer to RFID structure
+ * @param buffer Received bytes
+ * @param nbytes Number of received bytes
+ * @return Void
+ */
+static void rfid_parse(rfid_t *rfids, const char *buffer, int nbytes)
+{
+	int i;
+
+	for(i = 0; i < nbytes; i++)
+	{
+		// Start byte -> "NL"
+		if(buffer[i] == '\n') {
+			rfids->frame_len = 0;
+		}
+		// If "CR" received then check if 10 bytes collected, if yes -> publish
+		else if(buffer[i] == '\r') {
+			if(rfids->frame_len == 10) {
+				rfids->frame[10] = '\0';
+				slot_write(&rfids->reader_slot, rfids->frame, 11);
+			}
+			rfids->frame_len = 11;
+		}
+		// Collect bytes, drop the frame on overflow
+		else if(rfids->frame_len < 10) {
+			rfids->frame[rfids->frame_len++] = buffer[i];
+		}
+		else {
+			rfids->frame_len = 11;
+		}
+	}
+}
+
+/**
+ * Reader thread: parse tag frames as they arrive
+ * @param arg Pointer to RFID structure
+ * @return NULL
+ */
+static void *rfid_reader(void *arg)
+{
+	rfid_t *rfids = (rfid_t *)arg;
+	char buffer[32];
+	int  nbytes;
+	struct timeval tv;
+	fd_set infds;
+	sigset_t mask;
+
+	// SIGINT is handled by the main thread
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+	rfids->frame_len = 11; // Wait for the first start byte
+	while(__atomic_load_n(&rfids->reader_run, __ATOMIC_ACQUIRE))
+	{
+		// Wake up now and then to check if we should stop
+		tv.tv_sec = 0;
+		tv.tv_usec = 100000;
+		FD_ZERO(&infds);
+		FD_SET(rfids->sps->descriptor, &infds);
+		if(select(rfids->sps->descriptor + 1, &infds, NULL, NULL, &tv) <= 0)
+			continue;
+
+		// Read whatever arrived, not byte by byte
+		nbytes = (int)read(rfids->sps->descriptor, buffer, sizeof(buffer));
+		if(nbytes <= 0) {
+			// Port hung up, do not spin on it
+			usleep(100000);
+			continue;
+		}
+
+		rfid_parse(rfids, buffer, nbytes);
+	}
+
+	return NULL;
+}
+
+/**
+ * Start reader thread. Afterwards rfid_read() only checks for a new tag id
+ * and never blocks on the serial port
+ * @param rfids Pointer to RFID structure
+ * @return s_OK if successful, s_ERROR if failed
+ */
+int rfid_reader_start(rfid_t *rfids)
+{
+	if(rfids->sps->descriptor < 0)
+		return s_ERROR;
+
+	slot_init(&rfids->reader_slot);
+	rfids->reader_version = 0;
+
+	__atomic_store_n(&rfids->reader_run, s_TRUE, __ATOMIC_RELEASE);
+	if(pthread_create(&rfids->reader, NULL, rfid_reader, rfids) != 0)
+	{
+		printf("rfid_reader_start: could not create reader thread.\n");
+		__atomic_store_n(&rfids->reader_run, s_FALSE, __ATOMIC_RELEASE);
+		return s_ERROR;
+	}
+
+	return s_OK;
+}
+
+/**
+ * Stop reader thread
+ * @param rfids Pointer to RFID structure
+ * @return Void
+ */
+void rfid_reader_stop(rfid_t *rfids)
+{
+	if(!__atomic_load_n(&rfids->reader_run, __ATOMIC_ACQUIRE))
+		return;
+
+	__atomic_store_n(&rfids->reader_run, s_FALSE, __ATOMIC_RELEASE);
+	pthread_join(rfids->reader, NULL);
+}
+
+/**
+ * Parse tags in rfid_poll(), called by an event loop whenever the port is
+ * readable. Afterwards rfid_read() only checks for a new tag id
+ * @param rfids Pointer to RFID structure
+ * @return Void
+ */
+void rfid_poll_start(rfid_t *rfids)
+{
+	slot_init(&rfids->reader_slot);
+	rfids->reader_version = 0;
+	rfids->frame_len = 11;
+	rfids->reader_polled = s_TRUE;
+	serialport_nonblock(rfids->sps);
+}
+
+/**
+ * Parse the bytes waiting on the port (never blocks, rfid_poll_start makes
+ * the port non-blocking)
+ * @param rfids Pointer to RFID structure
+ * @return Void
+ */
+void rfid_poll(rfid_t *rfids)
+{
+	char buffer[32];
+	int nbytes;
+
+	nbytes = (int)read(rfids->sps->descriptor, buffer, sizeof(buffer));
+	if(nbytes > 0)
+		rfid_parse(rfids, buffer, nbytes);
+}
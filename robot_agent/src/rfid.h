@@ -13,8 +13,12 @@
 #define __RFID_H
 
 /* -- Includes -- */
+/* system libraries */
+#include <pthread.h>
+#include <stdint.h>
 /* project libraries */
 #include "serialport.h"
+#include "slot.h"
 
 /* -- Types -- */
 
@@ -27,6 +31,14 @@ typedef struct s_RFID_STRUCT
 	char id[11];				// current id read
 	char last_id[11];			// last id read
 
+	pthread_t reader;			// reader thread
+	int reader_run;				// reader thread is running (s_TRUE/s_FALSE)
+	int reader_polled;			// tags are parsed by rfid_poll() from an event loop (s_TRUE/s_FALSE)
+	slot_t reader_slot;			// last tag id published by the reader thread or rfid_poll()
+	uint32_t reader_version;	// version of the last tag id taken from the slot
+	char frame[11];				// tag frame being parsed
+	int frame_len;				// characters of the frame parsed so far, 11 while waiting for a start byte
+
 } rfid_t;
 
 /* -- Constants -- */
@@ -36,6 +48,10 @@ rfid_t *rfid_open(char *device_path); // Open RFID connection
 int rfid_close(rfid_t *rfids); // Close RFID connection
 int rfid_read_locked(rfid_t *rfids); // Read RFID tag ID (locks program until tag is read)
 int rfid_read(rfid_t *rfids); // Read RFID tag ID
+int rfid_reader_start(rfid_t *rfids); // Parse tags from a dedicated thread
+void rfid_reader_stop(rfid_t *rfids); // Stop reader thread
+void rfid_poll_start(rfid_t *rfids); // Parse tags in rfid_poll() instead of rfid_read()
+void rfid_poll(rfid_t *rfids); // Parse the bytes waiting on the port (never blocks)
 
 
 #endif /* __RFID_H */
@@ -0,0 +1,198 @@
+/**
+ * @file	rng.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Seedable random number generator library. Every subsystem draws from its
+ * own stream (s_RNG_STREAM_*), a xoshiro128** generator whose state is
+ * expanded from the configured seed and the stream number with splitmix64.
+ * The same seed replays the same numbers in every stream, and a change in
+ * how often one subsystem draws does not shift the numbers of the others.
+ *
+ * A stream has no lock: it is used by the tasks only, which the scheduler
+ * runs one at a time.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <math.h>
+/* project libraries */
+#include "rng.h"
+
+/* -- Types -- */
+
+/**
+ * @brief Random number stream
+ */
+typedef struct s_RNG_STRUCT
+{
+	uint32_t s[4]; // xoshiro128** state
+	double spare; // Second number of the last polar pair
+	int spare_ready; // spare is not used yet
+} rng_t;
+
+/* -- Global Variables -- */
+static rng_t rng_streams[s_RNG_STREAM_NUM];
+
+/* -- Functions -- */
+
+/**
+ * Next number of a splitmix64 sequence (expands the seed)
+ * @param x Pointer to sequence state
+ * @return 64 random bits
+ */
+static uint64_t rng_splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+	return z ^ (z >> 31);
+}
+
+/**
+ * Rotate left
+ * @param x Value
+ * @param k Number of bits (1 - 31)
+ * @return Rotated value
+ */
+static inline uint32_t rng_rotl(uint32_t x, int k)
+{
+	return (x << k) | (x >> (32 - k));
+}
+
+/**
+ * Advance a stream
+ * @param rng Pointer to stream
+ * @return 32 random bits
+ */
+static inline uint32_t rng_step(rng_t *rng)
+{
+	uint32_t *s = rng->s;
+	uint32_t result = rng_rotl(s[1] * 5, 7) * 9;
+	uint32_t t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rng_rotl(s[3], 11);
+
+	return result;
+}
+
+/**
+ * Seed all streams
+ * @param seed Seed (sim:seed in config.ini)
+ * @return Void
+ */
+void rng_init(unsigned int seed)
+{
+	int i;
+	uint64_t x, z;
+
+	for(i = 0; i < s_RNG_STREAM_NUM; i++)
+	{
+		// Different, never all-zero state per stream
+		x = ((uint64_t)seed << 8) | (uint64_t)i;
+		z = rng_splitmix64(&x);
+		rng_streams[i].s[0] = (uint32_t)z;
+		rng_streams[i].s[1] = (uint32_t)(z >> 32);
+		z = rng_splitmix64(&x);
+		rng_streams[i].s[2] = (uint32_t)z;
+		rng_streams[i].s[3] = (uint32_t)(z >> 32);
+		if((rng_streams[i].s[0] | rng_streams[i].s[1] | rng_streams[i].s[2] | rng_streams[i].s[3]) == 0)
+			rng_streams[i].s[0] = 1;
+		rng_streams[i].spare_ready = s_FALSE;
+	}
+}
+
+/**
+ * Get next 32 random bits
+ * @param stream Stream (s_RNG_STREAM_*)
+ * @return Random bits
+ */
+uint32_t rng_next(int stream)
+{
+	return rng_step(&rng_streams[stream]);
+}
+
+/**
+ * Get uniform integer
+ * @param stream Stream (s_RNG_STREAM_*)
+ * @param n Number of values (n > 0)
+ * @return Integer in [0, n)
+ */
+int rng_int(int stream, int n)
+{
+	// Multiply and shift, the bias is below n / 2^32
+	return (int)(((uint64_t)rng_step(&rng_streams[stream]) * (uint32_t)n) >> 32);
+}
+
+/**
+ * Get uniform number
+ * @param stream Stream (s_RNG_STREAM_*)
+ * @return Number in [0, 1)
+ */
+float rng_float(int stream)
+{
+	// 24 bits fill the float mantissa exactly
+	return (float)(rng_step(&rng_streams[stream]) >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * Get number from a normal (gaussian) distribution, Marsaglia polar method.
+ * The second number of a pair is kept for the next call of the same stream
+ * @param stream Stream (s_RNG_STREAM_*)
+ * @param mu Mean of gaussian
+ * @param sigma Standard deviation of gaussian
+ * @return Random number
+ */
+double rng_gauss(int stream, double mu, double sigma)
+{
+	rng_t *rng = &rng_streams[stream];
+	double v1, v2, s, f;
+
+	if(rng->spare_ready)
+	{
+		rng->spare_ready = s_FALSE;
+		return rng->spare * sigma + mu;
+	}
+
+	do
+	{
+		v1 = 2.0 * (rng_step(rng) * (1.0 / 4294967296.0)) - 1.0;
+		v2 = 2.0 * (rng_step(rng) * (1.0 / 4294967296.0)) - 1.0;
+		s = v1 * v1 + v2 * v2;
+	} while(s >= 1 || s == 0);
+
+	f = sqrt(-2 * log(s) / s);
+	rng->spare = v2 * f;
+	rng->spare_ready = s_TRUE;
+
+	return v1 * f * sigma + mu;
+}
+
+/**
+ * Fill array with uniform numbers
+ * @param stream Stream (s_RNG_STREAM_*)
+ * @param u Array
+ * @param num Number of elements
+ * @return Void
+ */
+void rng_fill_float(int stream, float *u, int num)
+{
+	int i;
+	rng_t rng = rng_streams[stream];
+
+	// Work on a local copy so the state stays in registers
+	for(i = 0; i < num; i++)
+	{
+		u[i] = (float)(rng_step(&rng) >> 8) * (1.0f / 16777216.0f);
+	}
+	rng_streams[stream] = rng;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file	rng.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Seedable random number generator library header file.
+ */
+
+#ifndef __RNG_H
+#define __RNG_H
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdint.h>
+/* project libraries */
+#include "def.h"
+
+/* -- Constants -- */
+#define s_RNG_STREAM_PF					0 // Particle filter
+#define s_RNG_STREAM_ROBOT				1 // Robot model (motion and sensing noise)
+#define s_RNG_STREAM_NAVIGATE			2 // Navigation and obstacle avoidance choices
+#define s_RNG_STREAM_NUM				3 // Number of streams
+
+/* -- Function Prototypes -- */
+void rng_init(unsigned int seed); // Seed all streams
+uint32_t rng_next(int stream); // Next 32 random bits
+int rng_int(int stream, int n); // Uniform integer in [0, n)
+float rng_float(int stream); // Uniform number in [0, 1)
+double rng_gauss(int stream, double mu, double sigma); // Number from a normal (gaussian) distribution
+void rng_fill_float(int stream, float *u, int num); // Fill array with uniform numbers in [0, 1)
+
+#endif /* __RNG_H */
@@ -18,6 +18,7 @@
 #include "general.h"
 #include "config.h"
 #include "def.h"
+#include "rng.h"
 
  /* -- Defines -- */
 
@@ -117,14 +118,14 @@ void robot_drive(robot_t *robot, int distance, int angle, int uncertain)
 	// Update angle
     if(angle != 0)
     {
-        robot->a = robot->a - ((angle + general_gaussrand(0, robot->turn_noise)) * M_PI/180);
+        robot->a = robot->a - ((angle + rng_gauss(s_RNG_STREAM_ROBOT, 0, robot->turn_noise)) * M_PI/180);
         robot->a = fmod(robot->a, M_PI * 2);
     }
 
     // Update position
     if(distance != 0)
     {
-        int dist_with_noise = distance + general_gaussrand(0, robot->move_noise);
+        int dist_with_noise = distance + rng_gauss(s_RNG_STREAM_ROBOT, 0, robot->move_noise);
         robot->x += cos(robot->a) * dist_with_noise;
         robot->y += sin(robot->a) * dist_with_noise;
     }
@@ -132,7 +133,7 @@ void robot_drive(robot_t *robot, int distance, int angle, int uncertain)
     // Robot is uncertain about its action, add just large noise
     if(uncertain > 0)
     {
-    	robot->a = robot->a - (general_gaussrand(0, s_CONFIG_PF_ANGLE_UNCERTANITY) * M_PI/180);
+    	robot->a = robot->a - (rng_gauss(s_RNG_STREAM_ROBOT, 0, s_CONFIG_PF_ANGLE_UNCERTANITY) * M_PI/180);
         robot->a = fmod(robot->a, M_PI * 2);
 
         robot->x += cos(robot->a) * s_CONFIG_PF_DISTANCE_UNCERTANITY;
@@ -174,7 +175,7 @@ float robot_sense_tag(robot_t *robot, rfid_t *rfids, enviroment_t *envs)
 	// Calculate distance to the tag
 	dist = sqrt(pow(robot->x - envs->tags[robot->tag_num].x, 2) +
 				pow(robot->y - envs->tags[robot->tag_num].y, 2));
-	dist += general_gaussrand(0, robot->sense_tag_noise);
+	dist += rng_gauss(s_RNG_STREAM_ROBOT, 0, robot->sense_tag_noise);
 
 	return dist;
 }
@@ -225,13 +226,13 @@ float robot_eval_tag(robot_t *robot, enviroment_t *envs)
 		robot->y < 0)
 	{
 		prob = 0.00001;
-		robot->x = rand() % envs->room_max_width;
-		robot->y = rand() % envs->room_max_height;
-		robot->a = fmod(rand(), M_PI * 2);
+		robot->x = rng_int(s_RNG_STREAM_ROBOT, envs->room_max_width);
+		robot->y = rng_int(s_RNG_STREAM_ROBOT, envs->room_max_height);
+		robot->a = rng_float(s_RNG_STREAM_ROBOT) * M_PI * 2;
 	}
 	else
 	{
-		prob = general_gaussian(dist, robot->sense_tag_noise, rand() % s_CONFIG_RFID_SENSE_RADIUS); // !!!
+		prob = general_gaussian(dist, robot->sense_tag_noise, rng_int(s_RNG_STREAM_ROBOT, s_CONFIG_RFID_SENSE_RADIUS)); // !!!
 		if(prob == 0)
 			prob = 0.00001;
 	}
@@ -260,9 +261,9 @@ float robot_eval_wall(robot_t *robot, enviroment_t *envs)
 		robot->y < 0)
 	{
 		prob = 0.00001;
-		robot->x = rand() % envs->room_max_width;
-		robot->y = rand() % envs->room_max_height;
-		robot->a = fmod(rand(), M_PI * 2);
+		robot->x = rng_int(s_RNG_STREAM_ROBOT, envs->room_max_width);
+		robot->y = rng_int(s_RNG_STREAM_ROBOT, envs->room_max_height);
+		robot->a = rng_float(s_RNG_STREAM_ROBOT) * M_PI * 2;
 	}
 	else
 	{
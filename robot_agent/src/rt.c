@@ -0,0 +1,118 @@
+/**
+ * @file	rt.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Real-time hardening library. Called once before the tasks allocate their
+ * data, so that page faults and migrations happen at startup and not in the
+ * first minutes of the mission. Every step that fails (usually for lack of
+ * privileges) is reported and skipped, the others still apply.
+ */
+
+#define _GNU_SOURCE // sched_setaffinity()
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <malloc.h>
+#include <sys/mman.h>
+/* project libraries */
+#include "rt.h"
+
+/* -- Functions -- */
+
+/**
+ * Touch the stack the executive may use, so that it is mapped (and locked)
+ * before the first task runs
+ * @return Void
+ */
+static void __attribute__((noinline)) rt_prefault_stack(void)
+{
+	volatile unsigned char stack[s_RT_STACK_PREFAULT];
+	long page = sysconf(_SC_PAGESIZE);
+	size_t i;
+
+	for(i = 0; i < sizeof(stack); i += page)
+		stack[i] = 0;
+}
+
+/**
+ * Lock memory, pin the calling thread to a core, make it SCHED_FIFO and
+ * prefault stack and heap. Threads created afterwards inherit the core
+ * @param cpu Core to pin to (-1 - do not pin)
+ * @param priority SCHED_FIFO priority (0 - keep the current policy)
+ * @return s_OK if every step succeeded, s_ERROR otherwise
+ */
+int rt_init(int cpu, int priority)
+{
+	int res = s_OK;
+	cpu_set_t cpus;
+	struct sched_param param;
+	void *heap;
+
+	// Keep current and future pages in RAM
+	if(mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+		printf("rt_init: could not lock memory (%s).\n", strerror(errno));
+		res = s_ERROR;
+	}
+
+	// Freed memory stays in the heap and large blocks are taken from it too,
+	// instead of being mapped (and faulted) again on every allocation
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+
+	if(cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(cpu, &cpus);
+		if(sched_setaffinity(0, sizeof(cpus), &cpus) < 0) {
+			printf("rt_init: could not pin to core %d (%s).\n", cpu, strerror(errno));
+			res = s_ERROR;
+		}
+	}
+
+	if(priority > 0) {
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = priority;
+		if(sched_setscheduler(0, SCHED_FIFO, &param) < 0) {
+			printf("rt_init: could not set SCHED_FIFO priority %d (%s).\n", priority, strerror(errno));
+			res = s_ERROR;
+		}
+	}
+
+	// Fault in the stack and grow the heap by the reserve, which then stays
+	rt_prefault_stack();
+	heap = malloc(s_RT_HEAP_PREFAULT);
+	if(heap != NULL) {
+		rt_prefault(heap, s_RT_HEAP_PREFAULT);
+		free(heap);
+	}
+
+	return res;
+}
+
+/**
+ * Touch every page of a memory block (read and write back, the content is kept)
+ * @param ptr Pointer to memory block
+ * @param size Size of memory block in bytes
+ * @return Void
+ */
+void rt_prefault(void *ptr, size_t size)
+{
+	volatile unsigned char *p = (volatile unsigned char *)ptr;
+	long page = sysconf(_SC_PAGESIZE);
+	size_t i;
+
+	if(p == NULL || size == 0)
+		return;
+
+	for(i = 0; i < size; i += page)
+		p[i] = p[i];
+	p[size - 1] = p[size - 1];
+}
@@ -0,0 +1,28 @@
+/**
+ * @file	rt.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Real-time hardening library header file.
+ */
+
+#ifndef __RT_H
+#define __RT_H
+
+/* -- Includes -- */
+/* system libraries */
+#include <stddef.h>
+/* project libraries */
+#include "def.h"
+
+/* -- Constants -- */
+#define s_RT_STACK_PREFAULT				(512 * 1024) // Stack touched at startup (bytes)
+#define s_RT_HEAP_PREFAULT				(8 * 1024 * 1024) // Heap touched and kept at startup (bytes)
+
+/* -- Function Prototypes -- */
+int rt_init(int cpu, int priority); // Lock memory, pin and prioritize the calling thread, prefault stack and heap
+void rt_prefault(void *ptr, size_t size); // Touch every page of a memory block
+
+#endif /* __RT_H */
@@ -8,33 +8,64 @@
  * Cyclic executive scheduler library.
  */
 
+#define _GNU_SOURCE // RUSAGE_THREAD
+
 /* -- Includes -- */
 /* system libraries */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #include <math.h>
 #include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
 /* project libraries */
 #include "scheduler.h"
 #include "task.h"
 #include "timelib.h"
+#include "histogram.h"
+#include "trace.h"
+#include "eventloop.h"
+#include "clocksync.h"
+#include "tdma.h"
+#include "adapt.h"
+#ifdef s_CONFIG_SCHEDULE_TABLE_ENABLE
+#include "schedule_table.h"
+#endif
 
 // Nr tasks
-#define     NR_TASKS_TO_HANDLE              7
+#define     NR_TASKS_TO_HANDLE              s_CONFIG_TASK_NUM
+
+// Upper limit of minor frames in a major cycle
+#define     SCHEDULER_MAX_FRAMES            1000
 
-// Major cycle to use
-#define     SCHEDULER_MAJOR_CYCLE           1000
+#ifndef s_CONFIG_SCHEDULE_TABLE_ENABLE
+// Order in which the tasks of one minor frame are dispatched
+// (a frame table generated by schedgen keeps the same order)
+static const int dispatch_order[NR_TASKS_TO_HANDLE] =
+{
+    s_TASK_COMMUNICATE_ID,
+    s_TASK_NAVIGATE_ID,
+    s_TASK_CONTROL_ID,
+    s_TASK_AVOID_ID,
+    s_TASK_REFINE_ID,
+    s_TASK_REPORT_ID,
+    s_TASK_MISSION_ID
+};
+#endif
 
-// Proposed periods (deadlines)
-#define     t_TASK_MISSION                  100
-#define     t_TASK_NAVIGATE                 100
-#define     t_TASK_CONTROL                  500
-#define     t_TASK_REFINE                   100
-#define     t_TASK_REPORT                   100
-#define     t_TASK_COMMUNICATE              1000
-#define     t_TASK_AVOID                    500
+// Short task names, indexed by task ID
+static const char *task_names[NR_TASKS_TO_HANDLE + 1] =
+{
+    "NOP", "MISS", "NAV", "CON", "REF", "REP", "COM", "AVO"
+};
 
 // Array holding the deadline overruns for every task
 // There are only 7 valid tasks, but there is a NOP
@@ -49,26 +80,557 @@ static cnt_t runtime_tasks[NR_TASKS_TO_HANDLE + 1]      = {0};
 //sleep time to sync with mission countrol
 static useconds_t sync_sleep_time = 0;
 
+// Host time when the scheduler started, to compare with the virtual run-time
+static struct timespec sim_ts_started;
+
+/**
+ * @brief Per-task profiling structure
+ */
+typedef struct s_SCHEDULER_TASK_STATS_STRUCT
+{
+    struct timespec ts_start; // Start of the last run (CLOCK_MONOTONIC)
+    struct timespec ts_end; // End of the last run (CLOCK_MONOTONIC)
+
+    histogram_t exec; // Execution time: own start to own end (us)
+    histogram_t response; // Response time: release to own end (us)
+    histogram_t cpu; // CPU time of the thread while running (us)
+    histogram_t blocked; // Execution time not spent on the CPU: I/O waits, preemption (us)
+
+    cnt_t minflt; // Minor page faults while running
+    cnt_t majflt; // Major page faults (disk I/O) while running
+    cnt_t nvcsw; // Voluntary context switches (blocked) while running
+    cnt_t nivcsw; // Involuntary context switches (preempted) while running
+
+} scheduler_task_stats_t;
+
+// Execution and response time profile of every task, indexed by task ID
+static scheduler_task_stats_t task_stats[NR_TASKS_TO_HANDLE + 1];
+
+// Release jitter of every minor cycle: how late (in microseconds)
+// the scheduler woke up with respect to the absolute release instant
+static histogram_t release_jitter;
+
+// Overload manager: current mode, hysteresis counters and time spent degraded
+static int overload_mode = s_SCHEDULER_MODE_NORMAL;
+static int overload_misses = 0; // High-criticality overruns since the last job with slack
+static int overload_slack_jobs = 0; // Consecutive high-criticality jobs with slack
+static cnt_t overload_switches = 0; // Number of mode switches
+static struct timespec overload_ts_degraded; // Start of the current degraded interval
+static long long overload_degraded_us = 0; // Time spent in closed degraded intervals
+
+// Background jobs, run round-robin in the slack at the end of each minor cycle
+static scheduler_job_t slack_jobs[s_SCHEDULER_JOB_NUM];
+static const char *slack_job_names[s_SCHEDULER_JOB_NUM];
+static cnt_t slack_job_runs[s_SCHEDULER_JOB_NUM]; // Calls of every job
+static int slack_job_num = 0;
+static struct timespec slack_end; // Jobs must return before this instant (zero outside the slack)
+static histogram_t slack_free; // Slack at the end of every cycle (us)
+static histogram_t slack_used; // Slack used by the background jobs in every cycle (us)
+
+// CPU time of the tasks in the current minor cycle, reported to the workload controller
+static long long cycle_cpu_time = 0;
+
+// Task control structures, indexed by task ID
+static task_t *task_controls[NR_TASKS_TO_HANDLE + 1] =
+{
+    NULL, &g_task_mission, &g_task_navigate, &g_task_control, &g_task_refine,
+    &g_task_report, &g_task_communicate, &g_task_avoid
+};
+
+timelib_ns_t notify_victim_time;
+timelib_ns_t motors_stop_time;
+cnt_t illegal_communications = 0;
+cnt_t total_communications = 0;
+cnt_t total_victims = 0;
+cnt_t inaccurate_victims = 0;
 cnt_t total_data_count[4] = {0};
 cnt_t actual_data_count[4] = {0};
 
 // Average of offset with the victims
 double victim_offset_average;
+
+/**
+ * @brief Periodic task thread of the fixed-priority executor
+ */
+typedef struct s_SCHEDULER_THREAD_STRUCT
+{
+    scheduler_t *ces; // Pointer to scheduler structure
+    int task_id; // Task ID
+    int priority; // SCHED_FIFO priority
+    int phase; // Phase offset (ms)
+    struct timespec ts_release; // Next release (CLOCK_MONOTONIC), written under the task lock
+    pthread_t thread; // Thread handle
+    int started; // Thread was created and must be joined (s_TRUE/s_FALSE)
+
+} scheduler_thread_t;
+
+// Threads of the fixed-priority executor, indexed by task ID
+static scheduler_thread_t task_threads[NR_TASKS_TO_HANDLE + 1];
+
+// The task bodies share globals without locking, so only one runs at a
+// time. A higher-priority release waits for at most one running body
+// (priority inheritance keeps middle-priority tasks from stretching that)
+static pthread_mutex_t task_lock;
+
+// Set by scheduler_stop() (from the SIGINT handler), the executive returns
+// and the task threads end after their current job
+static int stop_requested = s_FALSE;
+
+// Budget watchdog: the job being run and when its budget (WCET) runs out,
+// watched by a thread at the top priority that interrupts the job's I/O
+static pthread_t watchdog_thread;
+static pthread_mutex_t watchdog_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t watchdog_cond; // Signalled when a job starts or ends (CLOCK_MONOTONIC)
+static int watchdog_run = s_FALSE; // Watchdog thread is running
+static int watchdog_task_id = 0; // Task of the running job (0 - none)
+static pthread_t watchdog_task_thread; // Thread running the job
+static struct timespec watchdog_expiry; // Budget end of the running job, then next interrupt
+static int watchdog_violated = s_FALSE; // The running job already exceeded its budget
+static cnt_t budget_violations[NR_TASKS_TO_HANDLE + 1] = {0};
+
+// Task released in the dynamically allocated TDMA slot instead of a fixed
+// frame (0 - none, the TDMA phase is resolved statically)
+static int tdma_task_id = 0;
+
+// Greatest common divisor, used to compute the major cycle
+static unsigned scheduler_gcd(unsigned a, unsigned b)
+{
+    unsigned t;
+    while (b != 0)
+    {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ * Function:	    scheduler_get_phase
+ * Brief:	        Given a task id, it returns its phase offset, resolving
+ *                  the TDMA placeholder into this robot's slot
+ * @param ces:	    Pointer to scheduler structure
+ * @param task_id:	Task ID
+ * Returns:	        Phase offset in milliseconds
+ */
+static int scheduler_get_phase(scheduler_t *ces, int task_id)
+{
+    if (g_config.tasks[task_id].phase == s_CONFIG_TASK_PHASE_TDMA)
+    {
+        // One minor cycle per robot ID
+        return g_config.robot_id * (int)ces->minor;
+    }
+    return g_config.tasks[task_id].phase;
+}
+
+/*
+ * Function:	    scheduler_tdma_init
+ * Brief:	        Find the task placed in the TDMA slot and, if slots are
+ *                  allocated dynamically, start the allocation. That task is
+ *                  then checked every minor cycle instead of being put in the
+ *                  frames, so a slot must hold at least one minor cycle
+ * @param ces:	    Pointer to scheduler structure
+ * Returns:	        s_OK if successful, s_ERROR if the TDMA settings can not be used
+ */
+static int scheduler_tdma_init(scheduler_t *ces)
+{
+    int task_id;
+
+    tdma_task_id = 0;
+    if (!g_config.network_tdma_dynamic)
+    {
+        return s_OK;
+    }
+    for (task_id=1; task_id<=NR_TASKS_TO_HANDLE; ++task_id)
+    {
+        if (g_config.tasks[task_id].period > 0 && g_config.tasks[task_id].phase == s_CONFIG_TASK_PHASE_TDMA)
+        {
+            tdma_task_id = task_id;
+        }
+    }
+    if (tdma_task_id == 0)
+    {
+        return s_OK;
+    }
+    if (g_config.network_tdma_slot_num <= 0
+        || g_config.network_tdma_period / g_config.network_tdma_slot_num < (int)ces->minor)
+    {
+        fprintf(stderr, "scheduler: a TDMA slot (%d ms / %d) must be at least one minor cycle (%u ms)\n",
+                g_config.network_tdma_period, g_config.network_tdma_slot_num, ces->minor);
+        return s_ERROR;
+    }
+    return tdma_init(g_config.robot_id, g_config.network_tdma_slot_num, g_config.network_tdma_period);
+}
+
+#ifndef s_CONFIG_SCHEDULE_TABLE_ENABLE
+/*
+ * Function:	    scheduler_build_frames
+ * Brief:	        Build the minor frames of one major cycle from the task table.
+ *                  The major cycle is the hyperperiod of all periods. A table
+ *                  is rejected if a period or phase does not fit the minor-cycle
+ *                  grid, if the WCET budgets of a frame exceed the minor cycle, or
+ *                  if a task can not finish within its deadline in some frame
+ * @param ces:	    Pointer to scheduler structure
+ * Returns:	        s_OK if the table is feasible, s_ERROR otherwise
+ */
+static int scheduler_build_frames(scheduler_t *ces)
+{
+    unsigned i, j;
+    int task_id, phase;
+    config_task_t *task;
+    scheduler_frame_t *frame;
+
+    if (scheduler_tdma_init(ces) == s_ERROR)
+    {
+        return s_ERROR;
+    }
+
+    // Major cycle is the least common multiple of all periods
+    ces->major = ces->minor;
+    for (i=0; i<NR_TASKS_TO_HANDLE; ++i)
+    {
+        task_id = dispatch_order[i];
+        task = &g_config.tasks[task_id];
+        if (task->period <= 0 || task_id == tdma_task_id)
+        {
+            continue;
+        }
+        if (task->period % ces->minor != 0)
+        {
+            fprintf(stderr, "scheduler: %s period (%d ms) is not a multiple of the minor cycle (%u ms)\n",
+                    task_names[task_id], task->period, ces->minor);
+            return s_ERROR;
+        }
+        ces->major = ces->major / scheduler_gcd(ces->major, task->period) * task->period;
+        if (ces->major / ces->minor > SCHEDULER_MAX_FRAMES)
+        {
+            fprintf(stderr, "scheduler: major cycle exceeds %d minor frames\n", SCHEDULER_MAX_FRAMES);
+            return s_ERROR;
+        }
+    }
+    ces->frame_num = ces->major / ces->minor;
+    ces->frames = (scheduler_frame_t *) calloc(ces->frame_num, sizeof(scheduler_frame_t));
+
+    // The TDMA task can be due in any frame and is dispatched first
+    if (tdma_task_id != 0)
+    {
+        task = &g_config.tasks[tdma_task_id];
+        if (task->wcet > (int)ces->minor || task->wcet > task->deadline)
+        {
+            fprintf(stderr, "scheduler: %s budget (%d ms) does not fit a minor cycle (%u ms) and its deadline (%d ms)\n",
+                    task_names[tdma_task_id], task->wcet, ces->minor, task->deadline);
+            return s_ERROR;
+        }
+        for (j=0; j<ces->frame_num; ++j)
+        {
+            ces->frames[j].budget = task->wcet;
+        }
+    }
+
+    // Place every release of every task in its frame, in dispatch order
+    for (i=0; i<NR_TASKS_TO_HANDLE; ++i)
+    {
+        task_id = dispatch_order[i];
+        task = &g_config.tasks[task_id];
+        if (task->period <= 0 || task_id == tdma_task_id)
+        {
+            continue;
+        }
+        phase = scheduler_get_phase(ces, task_id);
+        if (phase < 0 || phase >= task->period || phase % ces->minor != 0)
+        {
+            fprintf(stderr, "scheduler: %s phase (%d ms) must be a multiple of the minor cycle below its period (%d ms)\n",
+                    task_names[task_id], phase, task->period);
+            return s_ERROR;
+        }
+        for (j=phase / ces->minor; j<ces->frame_num; j+=task->period / ces->minor)
+        {
+            frame = &ces->frames[j];
+            frame->tasks[frame->task_num++] = task_id;
+            frame->budget += task->wcet;
+            // In the worst case the task ends when all tasks up to it used their budgets
+            if (frame->budget > (int)ces->minor)
+            {
+                fprintf(stderr, "scheduler: frame %u overflows (%d ms of WCET budget in a %u ms minor cycle)\n",
+                        j, frame->budget, ces->minor);
+                return s_ERROR;
+            }
+            if (frame->budget > task->deadline)
+            {
+                fprintf(stderr, "scheduler: %s can miss its deadline (%d ms) in frame %u (%d ms of budget up to its end)\n",
+                        task_names[task_id], task->deadline, j, frame->budget);
+                return s_ERROR;
+            }
+        }
+    }
+
+    return s_OK;
+}
+#else
+/*
+ * Function:	    scheduler_load_table
+ * Brief:	        Build the minor frames of one major cycle from the frame
+ *                  table generated offline by schedgen (schedule_table.h).
+ *                  The generator already checked the frame constraints, so
+ *                  only the table shape and the TDMA robot are verified here
+ * @param ces:	    Pointer to scheduler structure
+ * Returns:	        s_OK if the table can be used, s_ERROR otherwise
+ */
+static int scheduler_load_table(scheduler_t *ces)
+{
+    unsigned i;
+    const scheduler_table_entry_t *entry;
+    scheduler_frame_t *frame;
+
+    if (s_SCHEDULE_TABLE_ROBOT_ID >= 0 && s_SCHEDULE_TABLE_ROBOT_ID != g_config.robot_id)
+    {
+        fprintf(stderr, "scheduler: frame table was generated for robot %d, this is robot %d\n",
+                s_SCHEDULE_TABLE_ROBOT_ID, g_config.robot_id);
+        return s_ERROR;
+    }
+    if (ces->minor != s_SCHEDULE_TABLE_MINOR)
+    {
+        printf("Scheduler: using the %d ms minor cycle of the frame table instead of %u ms\n",
+               s_SCHEDULE_TABLE_MINOR, ces->minor);
+        ces->minor = s_SCHEDULE_TABLE_MINOR;
+    }
+    ces->major = s_SCHEDULE_TABLE_MAJOR;
+    ces->frame_num = ces->major / ces->minor;
+    ces->frames = (scheduler_frame_t *) calloc(ces->frame_num, sizeof(scheduler_frame_t));
+
+    for (i=0; i<s_SCHEDULE_TABLE_ENTRY_NUM; ++i)
+    {
+        entry = &schedule_table[i];
+        if (entry->frame < 0 || (unsigned)entry->frame >= ces->frame_num
+            || entry->task_id < 1 || entry->task_id > NR_TASKS_TO_HANDLE
+            || ces->frames[entry->frame].task_num == NR_TASKS_TO_HANDLE)
+        {
+            fprintf(stderr, "scheduler: bad frame table entry %u\n", i);
+            return s_ERROR;
+        }
+        frame = &ces->frames[entry->frame];
+        frame->tasks[frame->task_num] = entry->task_id;
+        frame->slices[frame->task_num] = entry->slice;
+        frame->lags[frame->task_num] = entry->lag;
+        frame->task_num++;
+        frame->budget += entry->budget;
+    }
+
+    return s_OK;
+}
+#endif
+
+/*
+ * Function:	    scheduler_build_threads
+ * Brief:	        Assign fixed priorities for the SCHED_FIFO executor:
+ *                  rate-monotonic (shorter period first) or deadline-monotonic
+ *                  (shorter deadline first), ties broken by task ID. The top
+ *                  priority is left free for supervision threads
+ * @param ces:	    Pointer to scheduler structure
+ * Returns:	        s_OK if the task table can be run, s_ERROR otherwise
+ */
+static int scheduler_build_threads(scheduler_t *ces)
+{
+    int i, j, task_id, key_i, key_j, rank;
+    int prio_max = sched_get_priority_max(SCHED_FIFO);
+    config_task_t *task;
+    pthread_mutexattr_t attr;
+
+    if (scheduler_tdma_init(ces) == s_ERROR)
+    {
+        return s_ERROR;
+    }
+
+    ces->major = ces->minor;
+    ces->frame_num = 0;
+    for (task_id=1; task_id<=NR_TASKS_TO_HANDLE; ++task_id)
+    {
+        task = &g_config.tasks[task_id];
+        task_threads[task_id].ces = ces;
+        task_threads[task_id].task_id = task_id;
+        task_threads[task_id].priority = 0;
+        if (task->period <= 0)
+        {
+            continue;
+        }
+        task_threads[task_id].phase = scheduler_get_phase(ces, task_id);
+        if (task_threads[task_id].phase < 0 || task->deadline <= 0)
+        {
+            fprintf(stderr, "scheduler: %s needs a phase >= 0 ms and a deadline > 0 ms\n", task_names[task_id]);
+            return s_ERROR;
+        }
+        // The TDMA task thread wakes up every minor cycle to look for its slot
+        if (task_id == tdma_task_id)
+        {
+            task_threads[task_id].phase = 0;
+            continue;
+        }
+        ces->major = ces->major / scheduler_gcd(ces->major, task->period) * task->period;
+    }
+
+    // Rank every periodic task against all others
+    for (i=1; i<=NR_TASKS_TO_HANDLE; ++i)
+    {
+        if (g_config.tasks[i].period <= 0)
+        {
+            continue;
+        }
+        key_i = (g_config.scheduler_priority == s_CONFIG_PRIORITY_DM) ? g_config.tasks[i].deadline : g_config.tasks[i].period;
+        rank = 0;
+        for (j=1; j<=NR_TASKS_TO_HANDLE; ++j)
+        {
+            if (j == i || g_config.tasks[j].period <= 0)
+            {
+                continue;
+            }
+            key_j = (g_config.scheduler_priority == s_CONFIG_PRIORITY_DM) ? g_config.tasks[j].deadline : g_config.tasks[j].period;
+            if (key_j < key_i || (key_j == key_i && j < i))
+            {
+                ++rank;
+            }
+        }
+        task_threads[i].priority = prio_max - 1 - rank;
+    }
+
+    // Lock that serializes the task bodies, with priority inheritance
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&task_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    return s_OK;
+}
+
 /**
  * Initialize cyclic executive scheduler
  * @param minor Minor cycle in miliseconds (ms)
- * @return Pointer to scheduler structure
+ * @return Pointer to scheduler structure, NULL if the task table is infeasible
  */
 scheduler_t *scheduler_init(unsigned minor)
 {
+    unsigned i;
+    int j;
+
+    if (minor == 0)
+    {
+        fprintf(stderr, "scheduler: minor cycle must be larger than 0 ms\n");
+        return NULL;
+    }
+
     // Allocate memory for Scheduler structure
     scheduler_t *ces = (scheduler_t *) malloc(sizeof(scheduler_t));
-    assert(SCHEDULER_MAJOR_CYCLE % minor == 0);
     // Set minor cycle
     ces->minor = minor;
+    ces->frames = NULL;
+
+    // The fixed-priority executor runs one thread per task
+    if (g_config.scheduler_executor == s_CONFIG_EXECUTOR_FIFO)
+    {
+        if (scheduler_build_threads(ces) == s_ERROR)
+        {
+            fprintf(stderr, "scheduler: infeasible task table, check config.ini\n");
+            scheduler_destroy(ces);
+            return NULL;
+        }
+        printf("Scheduler: SCHED_FIFO executor, %s-monotonic priorities\n",
+               g_config.scheduler_priority == s_CONFIG_PRIORITY_DM ? "deadline" : "rate");
+        for (j=1; j<=NR_TASKS_TO_HANDLE; ++j)
+        {
+            if (g_config.tasks[j].period > 0)
+            {
+                printf("%s: priority %d (period %d ms, phase %d ms, deadline %d ms)\n", task_names[j],
+                       task_threads[j].priority, g_config.tasks[j].period, task_threads[j].phase, g_config.tasks[j].deadline);
+            }
+        }
+    }
+    // Build the frame schedule from the generated frame table or from the task table
+#ifdef s_CONFIG_SCHEDULE_TABLE_ENABLE
+    else if (scheduler_load_table(ces) == s_ERROR)
+#else
+    else if (scheduler_build_frames(ces) == s_ERROR)
+#endif
+    {
+        fprintf(stderr, "scheduler: infeasible task table, check config.ini\n");
+        scheduler_destroy(ces);
+        return NULL;
+    }
+
+    // Mission control time is only known modulo a minute, the position of a
+    // frame on its clock is only defined if the major cycle divides it
+    if (g_config.network_tdma_sync && ces->frame_num > 0 && s_CLOCKSYNC_WRAP % ces->major != 0)
+    {
+        fprintf(stderr, "scheduler: major cycle %u ms does not divide %d ms, can not sync to mission control (network tdma_sync)\n",
+                ces->major, s_CLOCKSYNC_WRAP);
+        scheduler_destroy(ces);
+        return NULL;
+    }
+
+    // Show the resulting schedule
+    if (ces->frame_num > 0)
+    {
+        printf("Scheduler: minor cycle %u ms, major cycle %u ms\n", ces->minor, ces->major);
+    }
+    for (i=0; i<ces->frame_num; ++i)
+    {
+        printf("Frame %u (%d ms):", i, ces->frames[i].budget);
+        for (j=0; j<ces->frames[i].task_num; ++j)
+        {
+            if (ces->frames[i].slices[j] > 0)
+            {
+                // Budget reserved for the spill-over of a split task
+                printf(" %s#%d", task_names[ces->frames[i].tasks[j]], ces->frames[i].slices[j]);
+            }
+            else
+            {
+                printf(" %s", task_names[ces->frames[i].tasks[j]]);
+            }
+        }
+        printf("\n");
+    }
+    if (tdma_task_id != 0)
+    {
+        printf("%s: dispatched first in the minor cycle that opens the dynamic TDMA slot of robot %d\n",
+               task_names[tdma_task_id], g_config.robot_id);
+    }
+
+    // Clear jitter, slack and task statistics
+    histogram_reset(&release_jitter);
+    histogram_reset(&slack_free);
+    histogram_reset(&slack_used);
+    for (i=0; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        histogram_reset(&task_stats[i].exec);
+        histogram_reset(&task_stats[i].response);
+        histogram_reset(&task_stats[i].cpu);
+        histogram_reset(&task_stats[i].blocked);
+    }
     return ces;
 }
 
+/*
+ * Function:	    scheduler_stop
+ * Brief:	        Ask the executive to stop. Only sets a flag, so it may be
+ *                  called from a signal handler: the cyclic executive returns
+ *                  at the end of the minor cycle, the task threads after their
+ *                  job and scheduler_run() once they are joined. The caller
+ *                  then frees the tasks and the scheduler
+ * Returns:	        Void
+ */
+void scheduler_stop(void)
+{
+    __atomic_store_n(&stop_requested, s_TRUE, __ATOMIC_RELEASE);
+}
+
+/*
+ * Function:	    scheduler_stopping
+ * Brief:	        Check if scheduler_stop() was called
+ * Returns:	        s_TRUE if so, s_FALSE otherwise
+ */
+static int scheduler_stopping(void)
+{
+    return __atomic_load_n(&stop_requested, __ATOMIC_ACQUIRE);
+}
+
 /**
  * Deinitialize cyclic executive scheduler
  * @param ces Pointer to scheduler structure
@@ -77,9 +639,169 @@ scheduler_t *scheduler_init(unsigned minor)
 void scheduler_destroy(scheduler_t *ces)
 {
     // Free memory
+    free(ces->frames);
     free(ces);
 }
 
+/*
+ * Function:	    scheduler_watchdog_signal
+ * Brief:	        Handler of s_SCHEDULER_WATCHDOG_SIGNAL. Does nothing, the
+ *                  signal only makes the blocking call of the job fail (EINTR)
+ * @param signo:	Signal number
+ * Returns:	        Void
+ */
+static void scheduler_watchdog_signal(int signo)
+{
+    (void)signo;
+}
+
+/*
+ * Function:	    scheduler_watchdog
+ * Brief:	        Budget watchdog thread. Sleeps until the budget of the running
+ *                  job ends. If the job is still running then, the violation is
+ *                  counted and the job's thread is signalled, so that the serial
+ *                  or network wait it is stuck in returns and the executive gets
+ *                  on with the next frame. The signal is repeated every
+ *                  s_SCHEDULER_WATCHDOG_RETRY ms until the job ends, since a job
+ *                  may try more I/O after the first one failed
+ * @param arg:	    Unused
+ * Returns:	        Never returns
+ */
+static void *scheduler_watchdog(void *arg)
+{
+    int task_id;
+
+    (void)arg;
+    pthread_mutex_lock(&watchdog_lock);
+    while (1)
+    {
+        if (watchdog_task_id == 0)
+        {
+            pthread_cond_wait(&watchdog_cond, &watchdog_lock);
+            continue;
+        }
+        // Woken up early when the job ends (or the next one starts)
+        if (pthread_cond_timedwait(&watchdog_cond, &watchdog_lock, &watchdog_expiry) != ETIMEDOUT
+            || watchdog_task_id == 0)
+        {
+            continue;
+        }
+
+        task_id = watchdog_task_id;
+        if (!watchdog_violated)
+        {
+            watchdog_violated = s_TRUE;
+            ++budget_violations[task_id];
+            trace_event(s_TRACE_EVENT_BUDGET, task_id, g_config.tasks[task_id].wcet);
+            printf("[Watchdog] %s exceeded its %d ms budget, I/O abandoned (%llu violations)\n",
+                    task_names[task_id], g_config.tasks[task_id].wcet, budget_violations[task_id]);
+        }
+        pthread_kill(watchdog_task_thread, s_SCHEDULER_WATCHDOG_SIGNAL);
+        timelib_timespec_add_ms(&watchdog_expiry, s_SCHEDULER_WATCHDOG_RETRY);
+    }
+
+    return NULL;
+}
+
+/*
+ * Function:	    scheduler_watchdog_start
+ * Brief:	        Start the budget watchdog thread at the top SCHED_FIFO priority
+ *                  (normal priority if not allowed)
+ * Returns:	        s_OK if successful, s_ERROR if failed
+ */
+static int scheduler_watchdog_start(void)
+{
+    struct sigaction sa;
+    pthread_condattr_t cattr;
+    pthread_attr_t attr;
+    struct sched_param param;
+    sigset_t mask, old_mask;
+    int res;
+
+    // Interrupted waits (select, epoll) fail, reads and writes are restarted
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = scheduler_watchdog_signal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(s_SCHEDULER_WATCHDOG_SIGNAL, &sa, NULL);
+
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&watchdog_cond, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    // The watchdog must not take SIGINT, the main thread handles it
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+
+    pthread_attr_init(&attr);
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    res = pthread_create(&watchdog_thread, &attr, scheduler_watchdog, NULL);
+    pthread_attr_destroy(&attr);
+    if (res == EPERM)
+    {
+        fprintf(stderr, "scheduler: no permission for SCHED_FIFO, budget watchdog runs with normal priority\n");
+        res = pthread_create(&watchdog_thread, NULL, scheduler_watchdog, NULL);
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+    if (res != 0)
+    {
+        fprintf(stderr, "scheduler: could not start the budget watchdog\n");
+        return s_ERROR;
+    }
+    watchdog_run = s_TRUE;
+    return s_OK;
+}
+
+/*
+ * Function:	    scheduler_watchdog_arm
+ * Brief:	        Tell the watchdog that a job starts (tasks without budget
+ *                  are not watched)
+ * @param task_id:	Task ID
+ * Returns:	        Void
+ */
+static void scheduler_watchdog_arm(int task_id)
+{
+    if (!watchdog_run || g_config.tasks[task_id].wcet <= 0)
+    {
+        return;
+    }
+    pthread_mutex_lock(&watchdog_lock);
+    watchdog_task_id = task_id;
+    watchdog_task_thread = pthread_self();
+    watchdog_violated = s_FALSE;
+    clock_gettime(CLOCK_MONOTONIC, &watchdog_expiry);
+    timelib_timespec_add_ms(&watchdog_expiry, g_config.tasks[task_id].wcet);
+    pthread_cond_signal(&watchdog_cond);
+    pthread_mutex_unlock(&watchdog_lock);
+}
+
+/*
+ * Function:	    scheduler_watchdog_disarm
+ * Brief:	        Tell the watchdog that the job ended
+ * Returns:	        Void
+ */
+static void scheduler_watchdog_disarm(void)
+{
+    if (!watchdog_run)
+    {
+        return;
+    }
+    pthread_mutex_lock(&watchdog_lock);
+    if (watchdog_task_id != 0)
+    {
+        watchdog_task_id = 0;
+        pthread_cond_signal(&watchdog_cond);
+    }
+    pthread_mutex_unlock(&watchdog_lock);
+}
+
 /**
  * Start scheduler
  * @param ces Pointer to scheduler structure
@@ -88,31 +810,143 @@ void scheduler_destroy(scheduler_t *ces)
 void scheduler_start(scheduler_t *ces)
 {
     // Set timers
-    timelib_timer_set(&ces->tv_started);
-    timelib_timer_set(&ces->tv_cycle);
+    timelib_timer_set(&ces->started);
+    // First minor cycle is released now, the following ones are released
+    // on an absolute grid on the monotonic clock (immune to wall-clock steps)
+    timelib_clock_gettime(&ces->ts_release);
+    ces->frame = 0;
+    clock_gettime(CLOCK_MONOTONIC, &sim_ts_started);
+
+    // Budgets are enforced in host time, a simulation has no real execution time
+    if (g_config.scheduler_watchdog && !timelib_clock_virtual())
+    {
+        scheduler_watchdog_start();
+    }
+}
+
+/**
+ * Register background job, run in the slack at the end of every minor cycle
+ * @param job Job function (see scheduler_job_t)
+ * @param name Short job name for the statistics
+ * @return s_OK if successful, s_ERROR if the job table is full
+ */
+int scheduler_add_job(scheduler_job_t job, const char *name)
+{
+    if (slack_job_num == s_SCHEDULER_JOB_NUM)
+    {
+        fprintf(stderr, "scheduler: no room for background job %s\n", name);
+        return s_ERROR;
+    }
+    slack_jobs[slack_job_num] = job;
+    slack_job_names[slack_job_num] = name;
+    slack_job_runs[slack_job_num] = 0;
+    ++slack_job_num;
+    return s_OK;
+}
+
+/**
+ * Slack left for the running background job. Jobs split their work so that
+ * every call returns within this budget
+ * @return Remaining slack in microseconds, 0 if exhausted or outside the slack
+ */
+long long scheduler_slack_remaining_us(void)
+{
+    struct timespec ts_now;
+    long long remaining;
+
+    if (slack_end.tv_sec == 0 && slack_end.tv_nsec == 0)
+    {
+        return 0;
+    }
+    timelib_clock_gettime(&ts_now);
+    remaining = timelib_timespec_diff_us(ts_now, slack_end);
+    return remaining > 0 ? remaining : 0;
+}
+
+/*
+ * Function:	    scheduler_run_jobs
+ * Brief:	        Run the background jobs round-robin until all of them are
+ *                  done for this cycle or the slack before the release is used up
+ * @param release:	Next release (CLOCK_MONOTONIC), jobs stop a guard time before it
+ * Returns:	        Void
+ */
+static void scheduler_run_jobs(const struct timespec *release)
+{
+    int i, left = slack_job_num;
+    int pending[s_SCHEDULER_JOB_NUM];
+    long long slack;
+
+    slack_end = *release;
+    timelib_timespec_sub_ms(&slack_end, s_SCHEDULER_SLACK_GUARD);
+    slack = scheduler_slack_remaining_us();
+    histogram_record(&slack_free, (unsigned long long)slack);
+
+    for (i=0; i<slack_job_num; ++i)
+    {
+        pending[i] = s_TRUE;
+    }
+    while (left > 0 && scheduler_slack_remaining_us() > 0)
+    {
+        for (i=0; i<slack_job_num && scheduler_slack_remaining_us() > 0; ++i)
+        {
+            if (pending[i] == s_FALSE)
+            {
+                continue;
+            }
+            ++slack_job_runs[i];
+            if (slack_jobs[i]() == s_FALSE)
+            {
+                pending[i] = s_FALSE;
+                --left;
+            }
+        }
+    }
+
+    histogram_record(&slack_used, (unsigned long long)(slack - scheduler_slack_remaining_us()));
+    slack_end.tv_sec = 0;
+    slack_end.tv_nsec = 0;
 }
 
 /**
- * Wait (sleep) till end of minor cycle
+ * Wait (sleep) till release of next minor cycle
  * @param ces Pointer to scheduler structure
  * @return Void
  */
 void scheduler_wait_for_timer(scheduler_t *ces)
 {
-    int sleep_time; // Sleep time in microseconds
+    struct timespec ts_now;
 
-    // Calculate time till end of the minor cycle
-    sleep_time = (ces->minor * 1000) - (int)(timelib_timer_get(ces->tv_cycle) * 1000);
+    // Next release is exactly one minor cycle after the current one. Sleeping
+    // to an absolute instant keeps wake-up errors from piling onto the next cycle
+    timelib_timespec_add_ms(&ces->ts_release, ces->minor);
 
-    // Add minor cycle period to timer
-    timelib_timer_add_ms(&ces->tv_cycle, ces->minor);
+    // Keep the frames on the TDMA grid of mission control: slew the release
+    // so that the next frame starts at its position in the major cycle
+    if (g_config.network_tdma_sync)
+    {
+        timelib_timespec_add_us(&ces->ts_release,
+                clocksync_correction_us(&ces->ts_release, ces->frame * ces->minor, ces->major));
+    }
+
+    // Report the load of the cycle to the workload controller
+    adapt_cycle(cycle_cpu_time, (long long)ces->minor * 1000);
+    cycle_cpu_time = 0;
+
+    // Use the slack for background jobs, they stop a guard time before the release
+    scheduler_run_jobs(&ces->ts_release);
 
-    // Check for overrun and execute sleep only if there is no
-    if(sleep_time > 0)
+    // Sleep until release, handling input as it arrives meanwhile. If we overran,
+    // the release is already in the past and the wait returns at once. Without
+    // the event loop, just sleep (the virtual clock jumps to the release)
+    if (eventloop_wait_until(&ces->ts_release, NULL) == s_ERROR)
     {
-        // Go to sleep (multipy with 1000 to get miliseconds)
-        usleep(sleep_time);
+        timelib_sleep_until(&ces->ts_release);
     }
+
+    // Record release jitter (wake-up time minus release instant)
+    timelib_clock_gettime(&ts_now);
+    long long jitter = timelib_timespec_diff_us(ces->ts_release, ts_now);
+    histogram_record(&release_jitter, jitter > 0 ? (unsigned long long)jitter : 0);
 }
 
 /**
@@ -160,6 +994,163 @@ void scheduler_exec_task(int task_id)
     }
 }
 
+/*
+ * Function:	    scheduler_task_thread
+ * Brief:	        Periodic task thread of the fixed-priority executor. Sleeps to
+ *                  each absolute release, then runs the task body under the task
+ *                  lock so the same statistics are kept as in the cyclic executive
+ * @param arg:	    Pointer to the thread structure
+ * Returns:	        NULL, at the first release after scheduler_stop()
+ */
+static void *scheduler_task_thread(void *arg)
+{
+    scheduler_thread_t *thread = (scheduler_thread_t *)arg;
+    int period = g_config.tasks[thread->task_id].period;
+
+    // The TDMA task only runs in the minor cycle that opens its slot
+    if (thread->task_id == tdma_task_id)
+    {
+        period = thread->ces->minor;
+    }
+    struct timespec ts_release, ts_now;
+    long long jitter;
+
+    ts_release = thread->ts_release;
+
+    while (1)
+    {
+        timelib_sleep_until(&ts_release);
+        timelib_clock_gettime(&ts_now);
+
+        pthread_mutex_lock(&task_lock);
+        if (scheduler_stopping())
+        {
+            pthread_mutex_unlock(&task_lock);
+            break;
+        }
+        if (thread->task_id != tdma_task_id || tdma_slot_due(&ts_release, thread->ces->minor))
+        {
+            // Release jitter is the wake-up delay of the task thread
+            jitter = timelib_timespec_diff_us(ts_release, ts_now);
+            histogram_record(&release_jitter, jitter > 0 ? (unsigned long long)jitter : 0);
+            scheduler_process_task(thread->task_id, &ts_release);
+        }
+
+        // Next release. Releases that passed while the job ran are skipped
+        // instead of run back-to-back, each counts as a job that overran
+        timelib_timespec_add_ms(&ts_release, period);
+        timelib_clock_gettime(&ts_now);
+        while (timelib_timespec_diff_us(ts_release, ts_now) > 0)
+        {
+            ++deadline_overruns[thread->task_id];
+            ++runtime_tasks[thread->task_id];
+            timelib_timespec_add_ms(&ts_release, period);
+        }
+        thread->ts_release = ts_release;
+        pthread_mutex_unlock(&task_lock);
+    }
+
+    return NULL;
+}
+
+/*
+ * Function:	    scheduler_run_threads
+ * Brief:	        Start one SCHED_FIFO thread per periodic task and wait. Falls
+ *                  back to normal threads if real-time priorities are not allowed
+ * Returns:	        Void, after scheduler_stop() once all task threads ended
+ *                  (at once if no thread could be started)
+ */
+static void scheduler_run_threads(scheduler_t *ces)
+{
+    int task_id, res, started = 0, realtime = s_TRUE;
+    pthread_attr_t attr;
+    struct sched_param param;
+    sigset_t mask, old_mask;
+    struct timespec ts_next;
+
+    // Task threads must not take SIGINT, the main thread handles it
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+
+    for (task_id=1; task_id<=NR_TASKS_TO_HANDLE; ++task_id)
+    {
+        if (g_config.tasks[task_id].period <= 0)
+        {
+            continue;
+        }
+        task_threads[task_id].started = s_FALSE;
+        task_threads[task_id].ts_release = ces->ts_release;
+        timelib_timespec_add_ms(&task_threads[task_id].ts_release, task_threads[task_id].phase);
+        pthread_attr_init(&attr);
+        if (realtime)
+        {
+            param.sched_priority = task_threads[task_id].priority;
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+            pthread_attr_setschedparam(&attr, &param);
+        }
+        res = pthread_create(&task_threads[task_id].thread, &attr, scheduler_task_thread, &task_threads[task_id]);
+        if (res == EPERM && realtime)
+        {
+            fprintf(stderr, "scheduler: no permission for SCHED_FIFO, task threads run with normal priority\n");
+            realtime = s_FALSE;
+            pthread_attr_destroy(&attr);
+            pthread_attr_init(&attr);
+            res = pthread_create(&task_threads[task_id].thread, &attr, scheduler_task_thread, &task_threads[task_id]);
+        }
+        pthread_attr_destroy(&attr);
+        if (res != 0)
+        {
+            fprintf(stderr, "scheduler: could not start the %s thread\n", task_names[task_id]);
+            continue;
+        }
+        task_threads[task_id].started = s_TRUE;
+        ++started;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+    // Until scheduler_stop() the main thread handles input as it arrives and
+    // runs the background jobs once per minor cycle, holding the task lock
+    // for both
+    while (started > 0 && !scheduler_stopping())
+    {
+        timelib_timespec_add_ms(&ces->ts_release, ces->minor);
+        if (eventloop_wait_until(&ces->ts_release, &task_lock) == s_ERROR)
+        {
+            timelib_sleep_until(&ces->ts_release);
+        }
+
+        pthread_mutex_lock(&task_lock);
+        adapt_cycle(cycle_cpu_time, (long long)ces->minor * 1000);
+        cycle_cpu_time = 0;
+        ts_next = ces->ts_release;
+        timelib_timespec_add_ms(&ts_next, ces->minor);
+        for (task_id=1; task_id<=NR_TASKS_TO_HANDLE; ++task_id)
+        {
+            if (g_config.tasks[task_id].period > 0
+                && timelib_timespec_diff_us(task_threads[task_id].ts_release, ts_next) > 0)
+            {
+                ts_next = task_threads[task_id].ts_release;
+            }
+        }
+        scheduler_run_jobs(&ts_next);
+        pthread_mutex_unlock(&task_lock);
+    }
+
+    // Each thread ends at its next release (at most one period), a job that
+    // is running is finished first
+    for (task_id=1; task_id<=NR_TASKS_TO_HANDLE; ++task_id)
+    {
+        if (task_threads[task_id].started)
+        {
+            pthread_join(task_threads[task_id].thread, NULL);
+            task_threads[task_id].started = s_FALSE;
+        }
+    }
+}
+
 /**
  * Run scheduler
  * @param ces Pointer to scheduler structure
@@ -167,78 +1158,87 @@ void scheduler_exec_task(int task_id)
  */
 void scheduler_run(scheduler_t *ces)
 {
-    // Local variables (define variables here)
-    struct timeval task_exec_time;
-    // Scheduler details
-    unsigned nr_minor_cycles;
-
-    nr_minor_cycles = SCHEDULER_MAJOR_CYCLE / ces->minor;
-
     unsigned i;
-    // Get UNIX timestamp to be sychronized with the clock of the router, in seconds
-    double timestamp = timelib_unix_timestamp() / 1e3;
-    // Compute the difference in microseconds with the next higher second
-    double diff = (ceil(timestamp) - timestamp) * 1e6;
-    // Round the obtained microsecond difference to a useconds_t type, which is what
-    // we will haveto sleep to synchronize
-    sync_sleep_time = (useconds_t) round(diff);
+    int j;
+    scheduler_frame_t *frame;
+    struct timespec ts_task_release;
+
+    // Get UNIX timestamp to be sychronized with the clock of the router
+    timelib_ns_t timestamp = timelib_wall_now();
+    // Compute the difference in microseconds with the next higher second,
+    // which is what we will have to sleep to synchronize
+    sync_sleep_time = (useconds_t)(((s_TIMELIB_NS_PER_S - timestamp % s_TIMELIB_NS_PER_S) % s_TIMELIB_NS_PER_S) / s_TIMELIB_NS_PER_US);
     // And sleep the scheduler
-    usleep(sync_sleep_time);
+    timelib_sleep_us(sync_sleep_time);
 
     // Run start the time struct
     scheduler_start(ces);
 
-    // Loop through all minor cycles in a big major cycle
-    while (1)
+    // Fixed-priority preemptive executor instead of the cyclic executive
+    if (g_config.scheduler_executor == s_CONFIG_EXECUTOR_FIFO)
     {
-        for (i=0; i<nr_minor_cycles; ++i)
-        {
-            // Set timer structure for deadline calculation at the start
-            // of every minor cycle
-            timelib_timer_set(&task_exec_time);
+        scheduler_run_threads(ces);
+        return;
+    }
 
-            // Communicate task runs every 1000, at the fifth minor
-            // cycle(tdma slot 5)
-            if (i == g_config.robot_id)
+    // Loop through all minor cycles in a big major cycle, a simulation
+    // ends after its duration in virtual time, any run after scheduler_stop()
+    while (!g_config.sim_enable || g_config.sim_duration <= 0
+            || timelib_timer_get(ces->started) < g_config.sim_duration * s_TIMELIB_NS_PER_S)
+    {
+        for (i=0; i<ces->frame_num; ++i)
+        {
+            // The TDMA task goes first when its slot opens in this frame
+            if (tdma_task_id != 0 && tdma_slot_due(&ces->ts_release, ces->minor))
             {
-                scheduler_process_task(s_TASK_COMMUNICATE_ID, &task_exec_time);
+                scheduler_process_task(tdma_task_id, &ces->ts_release);
             }
 
-            /************************ Navigate task *************************/
-            scheduler_process_task(s_TASK_NAVIGATE_ID, &task_exec_time);
-            /****************************************************************/
-
-            // To be run every 500ms
-            if (i % 5 == 0)
+            // Dispatch the tasks of this frame in table order
+            frame = &ces->frames[i];
+            for (j=0; j<frame->task_num; ++j)
             {
-                /************************ Control task **************************/
-                scheduler_process_task(s_TASK_CONTROL_ID, &task_exec_time);
+                // A split task runs to completion in its first slice, its later
+                // slices only keep the budget it spills into the following frames
+                if (frame->slices[j] > 0)
+                {
+                    continue;
+                }
+                // Jobs placed after their release frame are late by the lag
+                ts_task_release = ces->ts_release;
+                timelib_timespec_sub_ms(&ts_task_release, frame->lags[j]);
+                scheduler_process_task(frame->tasks[j], &ts_task_release);
             }
 
-            /************************ Avoid task ****************************/
-            scheduler_process_task(s_TASK_AVOID_ID, &task_exec_time);
-            /****************************************************************/
-
-            /************************ Refine task ***************************/
-            scheduler_process_task(s_TASK_REFINE_ID, &task_exec_time);
-            /****************************************************************/
-
-            /************************ Report task ***************************/
-            scheduler_process_task(s_TASK_REPORT_ID, &task_exec_time);
-            /****************************************************************/
-
-            /************************ Mission task **************************/
-            scheduler_process_task(s_TASK_MISSION_ID, &task_exec_time);
-            /****************************************************************/
-
             /*********************** IDLE time ******************************/
             // Wait until the end of the current minor cycle
+            ces->frame = (i + 1) % ces->frame_num;
             scheduler_wait_for_timer(ces);
             /****************************************************************/
+
+            if (scheduler_stopping())
+            {
+                return;
+            }
         }
     }
 }
 
+/*
+ * Function:	    scheduler_get_task_name
+ * Brief:	        Given a task id, it returns its short name
+ * @param task_id:	Task ID
+ * Returns:	        Short task name ("NAV", "CON", ...)
+ */
+const char *scheduler_get_task_name(int task_id)
+{
+    if (task_id < 0 || task_id > NR_TASKS_TO_HANDLE)
+    {
+        return "?";
+    }
+    return task_names[task_id];
+}
+
 /*
  * Function:	    scheduler_get_deadline
  * Brief:	        Given a task id, it returns its computed deadline
@@ -249,29 +1249,12 @@ void scheduler_run(scheduler_t *ces)
  */
 int scheduler_get_deadline(int task_id)
 {
-    /*
-     * We are going to assume the deadlines of the tasks to be 
-     * the equal to the periods.
-     */
-    switch (task_id)
-    {
-        case 1 :// Mission
-            return t_TASK_MISSION;
-        case 2:// Navigate
-            return t_TASK_NAVIGATE;
-        case 3:// Control
-            return t_TASK_CONTROL;
-        case 4:// Refine
-            return t_TASK_REFINE;
-        case 5:// Report
-            return t_TASK_REPORT;
-        case 6:// Communicate
-            return t_TASK_COMMUNICATE;
-        case 7:// Avoid
-            return t_TASK_AVOID;
-        default:// Wrong
-            return -1;
+    // Deadlines come from the task table (config.ini)
+    if (task_id < 1 || task_id > NR_TASKS_TO_HANDLE)
+    {
+        return -1;
     }
+    return g_config.tasks[task_id].deadline;
 }
 
 cnt_t scheduler_get_all_task_cnt()
@@ -285,6 +1268,17 @@ cnt_t scheduler_get_all_task_cnt()
     return sum;
 }
 
+cnt_t scheduler_get_all_budget_violations()
+{
+    cnt_t sum = 0;
+    unsigned i;
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        sum += budget_violations[i];
+    }
+    return sum;
+}
+
 cnt_t scheduler_get_all_deadline_overruns()
 {
     cnt_t sum = 0;
@@ -299,14 +1293,52 @@ cnt_t scheduler_get_all_deadline_overruns()
 void scheduler_dump_statistics(scheduler_t *ces)
 {
     unsigned i;
-    double scheduler_run_time =  (double)(timelib_timer_get(ces->tv_started) / 1000.0);
+    struct timespec ts_now, ts_host;
+    timelib_clock_gettime(&ts_now);
+    double scheduler_run_time = timelib_timer_get(ces->started) / 1e9;
     // First: output the number of tasks that were run
     printf("\n****************************************************************\n");
     printf("Scheduler minor cycle:\t\t%d ms\n", ces->minor);
+    printf("Scheduler major cycle:\t\t%d ms\n", ces->major);
     printf("Scheduler run-time:\t\t%.2f s\n", scheduler_run_time);
     printf("Scheduler sync-time:\t\t%.2f ms\n", (float)(sync_sleep_time) / 1000.0);
+    if (timelib_clock_virtual())
+    {
+        clock_gettime(CLOCK_MONOTONIC, &ts_host);
+        printf("Virtual clock:\t\t\t%.2f s simulated in %.2f s (seed %u)\n",
+                scheduler_run_time, timelib_timespec_diff_us(sim_ts_started, ts_host) / 1e6, g_config.sim_seed);
+    }
+    printf("Release jitter (us):\t\tmin %llu, mean %.1f, p50 %llu, p99 %llu, max %llu (%llu cycles)\n",
+            release_jitter.min,
+            histogram_mean(&release_jitter),
+            histogram_percentile(&release_jitter, 50),
+            histogram_percentile(&release_jitter, 99),
+            release_jitter.max,
+            release_jitter.count);
+    printf("Overload mode switches:\t\t%llu (%.2f s degraded, now %s)\n",
+            overload_switches,
+            (overload_degraded_us + (overload_mode == s_SCHEDULER_MODE_DEGRADED
+                ? timelib_timespec_diff_us(overload_ts_degraded, ts_now) : 0)) / 1e6,
+            overload_mode == s_SCHEDULER_MODE_DEGRADED ? "DEGRADED" : "NORMAL");
+    printf("Idle slack (us):\t\tmin %llu, mean %.1f, p50 %llu, max %llu, used by background jobs: mean %.1f, max %llu\n",
+            slack_free.min,
+            histogram_mean(&slack_free),
+            histogram_percentile(&slack_free, 50),
+            slack_free.max,
+            histogram_mean(&slack_used),
+            slack_used.max);
+    for (i=0; i<(unsigned)slack_job_num; ++i)
+    {
+        printf("Background job %s:\t\t%llu runs\n", slack_job_names[i], slack_job_runs[i]);
+    }
+    eventloop_dump_statistics();
+    clocksync_dump_statistics();
+    tdma_dump_statistics();
+    adapt_dump_statistics();
     printf("Nr. of performed tasks:\t\t%llu\n", scheduler_get_all_task_cnt());
-    printf("Nr. of detected overruns:\t%llu\n\n", scheduler_get_all_deadline_overruns());
+    printf("Nr. of detected overruns:\t%llu\n", scheduler_get_all_deadline_overruns());
+    printf("Nr. of budget violations:\t%llu%s\n\n", scheduler_get_all_budget_violations(),
+            watchdog_run ? "" : " (watchdog off)");
     printf("Application requirements:\n");
     printf("[Req 1] Avoid task call rate: %f ms\n", 1e3 / ((float)runtime_tasks[s_TASK_AVOID_ID] / (float)scheduler_run_time));
     printf("[Req 2] See messages printed to stdout (starting with \"[Req 2]\")\n");
@@ -343,10 +1375,29 @@ void scheduler_dump_statistics(scheduler_t *ces)
     printf("\n\nSummary of scheduler parameters:\n");
     printf("#_runs:\tNumber of times a given task has run\n");
     printf("#_do:\tNumber of deadline overruns a given task has experienced\n");
+    printf("#_bv:\tNumber of times a given task exceeded its budget (wcet in\n");
+    printf("\tthe task table) and had its I/O abandoned by the watchdog\n");
     printf("%%_self:\tPercentage of overruns with respect to the number of\n");
     printf("\ttimes that task ran\n");
     printf("%%_all:\tPercentage of overruns with respect to the global number\n");
-    printf("\tof overruns\n\n");
+    printf("\tof overruns\n");
+    printf("wcet:\tLongest observed execution time of a given task (ms),\n");
+    printf("\tmeasured from its own start to its own end\n");
+    printf("p99:\t99th percentile of the execution time (ms)\n");
+    printf("mean:\tMean execution time (ms)\n");
+    printf("rt_p99:\t99th percentile of the response time (ms), measured from\n");
+    printf("\tthe release of the job to the end of the task\n");
+    printf("rt_max:\tLongest observed response time (ms)\n");
+    printf("cpu:\tMean CPU time of the task thread per run (ms)\n");
+    printf("cpu_max:\tLongest CPU time of a run (ms)\n");
+    printf("blk:\tMean time per run the task was not on the CPU (ms):\n");
+    printf("\tblocked on serial or sockets, or preempted\n");
+    printf("blk_max:\tLongest such time in a run (ms)\n");
+    printf("%%_cpu:\tShare of the execution time spent on the CPU\n");
+    printf("minflt:\tMinor page faults taken by a given task\n");
+    printf("majflt:\tMajor page faults (read from disk) taken by a given task\n");
+    printf("vcsw:\tVoluntary context switches (the task blocked)\n");
+    printf("ivcsw:\tInvoluntary context switches (the task was preempted)\n\n");
     printf("SUMMARY\n-------------------\n");
     printf("\tMISS\t\tNAV\t\tCON\t\tREF\t\tREP\t\tCOM\t\tAVO\n");
     printf("\t----\t\t---\t\t---\t\t---\t\t---\t\t---\t\t---\n");
@@ -360,6 +1411,11 @@ void scheduler_dump_statistics(scheduler_t *ces)
     {
         printf("%llu\t\t", deadline_overruns[i]);
     }
+    printf("\n#_bv\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%llu\t\t", budget_violations[i]);
+    }
     printf("\n%%_self\t");
     for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
     {
@@ -372,6 +1428,77 @@ void scheduler_dump_statistics(scheduler_t *ces)
         printf("%.2f%%\t\t",
                 100 * ((float)deadline_overruns[i] / (float)scheduler_get_all_deadline_overruns()));
     }
+    printf("\nwcet\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", task_stats[i].exec.max / 1000.0);
+    }
+    printf("\np99\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", histogram_percentile(&task_stats[i].exec, 99) / 1000.0);
+    }
+    printf("\nmean\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", histogram_mean(&task_stats[i].exec) / 1000.0);
+    }
+    printf("\nrt_p99\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", histogram_percentile(&task_stats[i].response, 99) / 1000.0);
+    }
+    printf("\nrt_max\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", task_stats[i].response.max / 1000.0);
+    }
+    printf("\ncpu\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", histogram_mean(&task_stats[i].cpu) / 1000.0);
+    }
+    printf("\ncpu_max\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", task_stats[i].cpu.max / 1000.0);
+    }
+    printf("\nblk\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", histogram_mean(&task_stats[i].blocked) / 1000.0);
+    }
+    printf("\nblk_max\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f\t\t", task_stats[i].blocked.max / 1000.0);
+    }
+    printf("\n%%_cpu\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%.2f%%\t\t", task_stats[i].cpu.sum + task_stats[i].blocked.sum > 0
+                ? 100 * ((float)task_stats[i].cpu.sum / (float)(task_stats[i].cpu.sum + task_stats[i].blocked.sum)) : 0);
+    }
+    printf("\nminflt\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%llu\t\t", task_stats[i].minflt);
+    }
+    printf("\nmajflt\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%llu\t\t", task_stats[i].majflt);
+    }
+    printf("\nvcsw\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%llu\t\t", task_stats[i].nvcsw);
+    }
+    printf("\nivcsw\t");
+    for (i=1; i<NR_TASKS_TO_HANDLE + 1; ++i)
+    {
+        printf("%llu\t\t", task_stats[i].nivcsw);
+    }
     printf("\n\nOVERALL PERFORMANCE OF SCHEDULER:\t%.2f%%\n",
             100 * ( 1 - ((float)scheduler_get_all_deadline_overruns() / (float)scheduler_get_all_task_cnt())));
     printf("OVERALL DEADLINE OVERRUNS OF SCHEDULER:\t%.2f%%\n",
@@ -379,24 +1506,168 @@ void scheduler_dump_statistics(scheduler_t *ces)
     printf("****************************************************************\n");
 }
 
-void scheduler_process_task(int task_id, struct timeval *timer)
+/*
+ * Function:	    scheduler_get_mode
+ * Brief:	        Returns the current overload manager mode
+ * Returns:	        s_SCHEDULER_MODE_NORMAL or s_SCHEDULER_MODE_DEGRADED
+ */
+int scheduler_get_mode(void)
+{
+    return overload_mode;
+}
+
+/*
+ * Function:	    scheduler_set_mode
+ * Brief:	        Switch the overload manager mode: flag every low-criticality
+ *                  task as degraded (or restore it) and log the switch with its cause
+ * @param mode:	    New mode (s_SCHEDULER_MODE_*)
+ * @param task_id:	High-criticality task whose job caused the switch
+ * @param cause:	Human readable cause of the switch
+ * @param now:	    Time of the switch (CLOCK_MONOTONIC)
+ * Returns:	        Void
+ */
+static void scheduler_set_mode(int mode, int task_id, const char *cause, struct timespec *now)
+{
+    int i;
+
+    for (i=1; i<=NR_TASKS_TO_HANDLE; ++i)
+    {
+        if (g_config.tasks[i].criticality == s_CONFIG_CRITICALITY_LOW)
+        {
+            task_controls[i]->degraded = (mode == s_SCHEDULER_MODE_DEGRADED) ? s_TRUE : s_FALSE;
+        }
+    }
+
+    if (mode == s_SCHEDULER_MODE_DEGRADED)
+    {
+        overload_ts_degraded = *now;
+    }
+    else
+    {
+        overload_degraded_us += timelib_timespec_diff_us(overload_ts_degraded, *now);
+    }
+    overload_mode = mode;
+    ++overload_switches;
+    overload_misses = 0;
+    overload_slack_jobs = 0;
+
+    printf("[Overload] %s mode: %s\n", mode == s_SCHEDULER_MODE_DEGRADED ? "DEGRADED" : "NORMAL", cause);
+    trace_event(s_TRACE_EVENT_MODE_CHANGE, mode, task_id);
+}
+
+/*
+ * Function:	    scheduler_update_mode
+ * Brief:	        Overload manager. Degrades the low-criticality tasks after
+ *                  overload_trigger overruns of high-criticality tasks, and
+ *                  restores them after overload_recover consecutive
+ *                  high-criticality jobs that finished with overload_slack
+ *                  percent of their deadline to spare
+ * @param task_id:	    High-criticality task that just finished
+ * @param response_time: Response time of the job (us)
+ * @param now:	        End of the job (CLOCK_MONOTONIC)
+ * Returns:	        Void
+ */
+static void scheduler_update_mode(int task_id, long long response_time, struct timespec *now)
+{
+    long long deadline = (long long)g_config.tasks[task_id].deadline * 1000;
+    char cause[128];
+
+    if (response_time > deadline)
+    {
+        overload_slack_jobs = 0;
+        if (++overload_misses >= g_config.overload_trigger && overload_mode == s_SCHEDULER_MODE_NORMAL)
+        {
+            sprintf(cause, "%s overran its %d ms deadline (response %.2f ms, %llu overruns)",
+                    task_names[task_id], g_config.tasks[task_id].deadline,
+                    response_time / 1000.0, deadline_overruns[task_id]);
+            scheduler_set_mode(s_SCHEDULER_MODE_DEGRADED, task_id, cause, now);
+        }
+    }
+    else if (response_time * 100 <= deadline * (100 - g_config.overload_slack))
+    {
+        overload_misses = 0;
+        if (++overload_slack_jobs >= g_config.overload_recover && overload_mode == s_SCHEDULER_MODE_DEGRADED)
+        {
+            sprintf(cause, "%d high-criticality jobs in a row finished with at least %d%% slack (last: %s, %.2f ms)",
+                    overload_slack_jobs, g_config.overload_slack, task_names[task_id], response_time / 1000.0);
+            scheduler_set_mode(s_SCHEDULER_MODE_NORMAL, task_id, cause, now);
+        }
+    }
+    else
+    {
+        // Deadline met, but not enough slack to count for recovery
+        overload_slack_jobs = 0;
+    }
+}
+
+/**
+ * Wrapper for task execution: run task, profile it and check its deadline
+ * @param task_id Task ID
+ * @param release Release instant of the minor cycle the task runs in (CLOCK_MONOTONIC)
+ * @return Void
+ */
+void scheduler_process_task(int task_id, struct timespec *release)
 {
     int deadline;
-    double exec_time;
+    long long exec_time, response_time, cpu_time;
+    struct rusage ru_start, ru_end;
+    struct timespec ts_cpu_start, ts_cpu_end;
+    scheduler_task_stats_t *stats = &task_stats[task_id];
 
-   // Execute the task
+    // Execute the task, time-stamping its own start and end. Faults and
+    // context switches are counted for the running thread only
+    trace_event(s_TRACE_EVENT_TASK_BEGIN, task_id, 0);
+    getrusage(RUSAGE_THREAD, &ru_start);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_cpu_start);
+    timelib_clock_gettime(&stats->ts_start);
+    scheduler_watchdog_arm(task_id);
     scheduler_exec_task(task_id);
-    // Obtain execution time
-    exec_time = timelib_timer_get(*timer);
+    scheduler_watchdog_disarm();
+    timelib_clock_gettime(&stats->ts_end);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts_cpu_end);
+    getrusage(RUSAGE_THREAD, &ru_end);
+    trace_event(s_TRACE_EVENT_TASK_END, task_id, 0);
+
+    stats->minflt += ru_end.ru_minflt - ru_start.ru_minflt;
+    stats->majflt += ru_end.ru_majflt - ru_start.ru_majflt;
+    stats->nvcsw += ru_end.ru_nvcsw - ru_start.ru_nvcsw;
+    stats->nivcsw += ru_end.ru_nivcsw - ru_start.ru_nivcsw;
+
+    // Sample the depth of the inter-task queues (recorded only when changed)
+    trace_queue_depth(s_TRACE_QUEUE_MISSION, g_queue_mission->count);
+    trace_queue_depth(s_TRACE_QUEUE_NAVIGATE, g_queue_navigate->count);
+    trace_queue_depth(s_TRACE_QUEUE_SEND_ROBOT, g_list_send_robot->count);
+    trace_queue_depth(s_TRACE_QUEUE_SEND_VICTIM, g_list_send_victim->count);
+    trace_queue_depth(s_TRACE_QUEUE_SEND_PHEROMONES, g_list_send_pheromones->count);
+    trace_queue_depth(s_TRACE_QUEUE_SEND_STREAM, g_list_send_stream->count);
+
+    // Execution time only covers this task, response time also covers
+    // everything that ran before it in the same minor cycle
+    exec_time = timelib_timespec_diff_us(stats->ts_start, stats->ts_end);
+    response_time = timelib_timespec_diff_us(*release, stats->ts_end);
+    histogram_record(&stats->exec, exec_time > 0 ? (unsigned long long)exec_time : 0);
+    histogram_record(&stats->response, response_time > 0 ? (unsigned long long)response_time : 0);
+
+    // The rest of the execution time the thread was off the CPU (blocked on
+    // serial or sockets, or preempted). The virtual clock does not advance
+    // while a task runs, so there all of it counts as CPU time
+    cpu_time = timelib_timespec_diff_us(ts_cpu_start, ts_cpu_end);
+    histogram_record(&stats->cpu, cpu_time > 0 ? (unsigned long long)cpu_time : 0);
+    histogram_record(&stats->blocked, exec_time > cpu_time ? (unsigned long long)(exec_time - cpu_time) : 0);
+    cycle_cpu_time += cpu_time > 0 ? cpu_time : 0;
+
     // Fetch deadline
     deadline = scheduler_get_deadline(task_id);
-    // Check for deadline overrun: if detected, add up counter; if not,
-    // just sleep until the deadline
-    if (exec_time > deadline)
+    // Check for deadline overrun (deadline is relative to the release)
+    if (response_time > (long long)deadline * 1000)
     {
         ++deadline_overruns[task_id];
     }
     ++runtime_tasks[task_id];
-}
-
 
+    // Protect the high-criticality tasks from overload
+    if (g_config.overload_enable && g_config.tasks[task_id].criticality == s_CONFIG_CRITICALITY_HIGH)
+    {
+        scheduler_update_mode(task_id, response_time, &stats->ts_end);
+    }
+}
@@ -11,37 +11,97 @@
 #ifndef __SCHEDULER_H
 #define __SCHEDULER_H
 
+#include <time.h>
+
 #include "def.h"
+#include "timelib.h"
+/**
+ * @brief Minor frame structure (tasks dispatched in one minor cycle)
+ */
+typedef struct s_SCHEDULER_FRAME_STRUCT
+{
+	int task_num; // Number of tasks in the frame
+	int tasks[s_CONFIG_TASK_NUM]; // Task IDs in dispatch order
+	int slices[s_CONFIG_TASK_NUM]; // Slice of each task, 0 dispatches it, >0 only reserves budget for a split task
+	int lags[s_CONFIG_TASK_NUM]; // Frame start minus release of each task (ms)
+	int budget; // Sum of WCET budgets of the tasks in the frame (ms)
+
+} scheduler_frame_t;
+
+/**
+ * @brief Entry of a frame table generated offline by schedgen
+ */
+typedef struct s_SCHEDULER_TABLE_ENTRY_STRUCT
+{
+	int frame; // Minor frame index
+	int task_id; // Task ID
+	int slice; // Slice index, 0 dispatches the task, >0 reserves budget for its spill-over
+	int lag; // Frame start minus release of the job (ms)
+	int budget; // Budget of the slice (ms)
+
+} scheduler_table_entry_t;
+
+/**
+ * @brief Background job, run in the slack at the end of each minor cycle.
+ * A job does one chunk of work that fits scheduler_slack_remaining_us() and
+ * returns s_TRUE if it has more work left, s_FALSE when done for this cycle
+ */
+typedef int (*scheduler_job_t)(void);
+
 /**
  * @brief Scheduler structure
  */
 typedef struct s_SCHEDULER_STRUCT
 {
 	unsigned int minor; // Minor cycle in miliseconds (ms)
+	unsigned int major; // Major cycle in miliseconds (ms), hyperperiod of the task table
 
-	struct timeval tv_started; // Timer that registers when scheduler started
-	struct timeval tv_cycle; // Timer for cycle sleeps/interrupts
+	unsigned int frame_num; // Number of minor frames in a major cycle
+	scheduler_frame_t *frames; // Frame schedule of one major cycle
+
+	timelib_ns_t started; // Timer that registers when scheduler started (monotonic)
+	struct timespec ts_release; // Absolute release instant of the current minor cycle (CLOCK_MONOTONIC)
+	unsigned int frame; // Frame released next (index into frames)
 
 } scheduler_t;
 
+/* -- Constants -- */
+/* Overload manager modes */
+#define s_SCHEDULER_MODE_NORMAL			0 // All tasks run their full job
+#define s_SCHEDULER_MODE_DEGRADED		1 // Low-criticality tasks skip optional work
+
+/* Background jobs */
+#define s_SCHEDULER_JOB_NUM				8 // Maximum number of background jobs
+#define s_SCHEDULER_SLACK_GUARD			1 // Slack left free before the next release (ms)
+
+/* Budget watchdog */
+#define s_SCHEDULER_WATCHDOG_SIGNAL		SIGUSR1 // Signal that interrupts the I/O of a job over budget
+#define s_SCHEDULER_WATCHDOG_RETRY		5 // Interval of further interrupts while the job still runs (ms)
+
 /* -- Function Prototypes -- */
 
 /*
  * Function:	    scheduler_init
- * Brief:	        Initialize cyclic executive scheduler
+ * Brief:	        Initialize cyclic executive scheduler and build its frame
+ *                  schedule from the task table in g_config
  * @param minor:	The minor cycle to use
- * @asserts:        If major cycle is not a multiple of the minor cycle
- * Returns:	        Nothing
+ * Returns:	        Pointer to scheduler structure, NULL if the task table
+ *                  is infeasible (the reason is printed to stderr)
 */
 scheduler_t *scheduler_init(unsigned minor); // Initialize cyclic executive scheduler
 void scheduler_destroy(scheduler_t *ces); // Deinitialize cyclic executive scheduler
 void scheduler_start(scheduler_t *ces); // Start scheduler
-void scheduler_wait_for_timer(scheduler_t *ces); // Wait (sleep) till end of minor cycle
+void scheduler_wait_for_timer(scheduler_t *ces); // Wait (sleep) till release of next minor cycle
 void scheduler_exec_task(int task_id); // Execute task
-void scheduler_run(scheduler_t *ces); // Run scheduler
+void scheduler_run(scheduler_t *ces); // Run scheduler (returns after scheduler_stop() or at the end of a simulation)
+void scheduler_stop(void); // Ask the scheduler to stop (safe in a signal handler)
 int  scheduler_get_deadline(int task_id); // Get deadline for specific task
-// Wrapper for task execution: init timers, calculate deadline & exec time
-void scheduler_process_task(int task_id, struct timeval* timer);
+const char *scheduler_get_task_name(int task_id); // Get short name of specific task
+int  scheduler_get_mode(void); // Get current overload manager mode
+int  scheduler_add_job(scheduler_job_t job, const char *name); // Register background job
+long long scheduler_slack_remaining_us(void); // Slack left for the running background job (us)
+// Wrapper for task execution: run task, profile execution & response time, check deadline
+void scheduler_process_task(int task_id, struct timespec *release);
 // Dump runtime statistics. No scheduler parameter is given since
 // this function shall be called from outside main routine
 void scheduler_dump_statistics(scheduler_t *ces);
@@ -50,5 +110,7 @@ void scheduler_dump_statistics(scheduler_t *ces);
 cnt_t scheduler_get_all_task_cnt();
 // Get the overall deadline overrun count
 cnt_t scheduler_get_all_deadline_overruns();
+// Get the overall budget violation count
+cnt_t scheduler_get_all_budget_violations();
 
 #endif /* __SCHEDULER_H */
@@ -50,6 +50,22 @@ serialport_t *serialport_open(const char *name)
 	return sps;
 }
 
+/**
+ * Make reads return at once when no byte is waiting (for ports served by an
+ * event loop, a spurious wake-up must not block it)
+ * @param sps Pointer to serial port structure
+ * @return s_OK if successful, s_ERROR if failed
+ */
+int serialport_nonblock(serialport_t *sps)
+{
+	int flags = fcntl(sps->descriptor, F_GETFL, 0);
+
+	if (flags == s_ERROR || fcntl(sps->descriptor, F_SETFL, flags | O_NONBLOCK) == s_ERROR)
+		return s_ERROR;
+
+	return s_OK;
+}
+
 /**
  * Close serial port
  * @param sps Pointer to serial port structure
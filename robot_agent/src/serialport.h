@@ -39,6 +39,7 @@ int serialport_config(serialport_t *sps, unsigned int baud); // Configure serial
 int serialport_write(serialport_t *sps, unsigned char *data, unsigned int bytes); // Write data to serial port
 int serialport_byte(serialport_t *sps, unsigned char byte); // Write one byt to serial port
 int serialport_flush_input(serialport_t *sps); // Flush input buffer
+int serialport_nonblock(serialport_t *sps); // Make reads return at once when no byte is waiting
 //int serialport_read(serialport_t *sps, char *data, int bytes); // Read dara from serial port
 
 #endif /* __SERIALPORT_H */
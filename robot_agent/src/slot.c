@@ -0,0 +1,81 @@
+/**
+ * @file	slot.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Lock-free single-writer slot library. A device thread publishes its latest
+ * sample and any number of readers copy it without locks: the writer makes the
+ * sequence odd while it updates the data, and a reader retries if the sequence
+ * was odd or changed during its copy. The writer never waits for readers.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <string.h>
+/* project libraries */
+#include "slot.h"
+
+/* -- Defines -- */
+
+/* -- Functions -- */
+
+/**
+ * Clear slot
+ * @param slot Pointer to slot structure
+ * @return Void
+ */
+void slot_init(slot_t *slot)
+{
+	memset(slot, 0, sizeof(slot_t));
+}
+
+/**
+ * Publish sample (must be called from one writer only)
+ * @param slot Pointer to slot structure
+ * @param sample Sample to publish
+ * @param size Sample size in bytes (at most s_SLOT_WORDS * 4)
+ * @return Void
+ */
+void slot_write(slot_t *slot, const void *sample, unsigned int size)
+{
+	uint32_t words[s_SLOT_WORDS] = {0};
+	uint32_t seq;
+	int i;
+
+	memcpy(words, sample, size);
+
+	seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	for(i = 0; i < s_SLOT_WORDS; i++)
+		__atomic_store_n(&slot->data[i], words[i], __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * Copy latest sample
+ * @param slot Pointer to slot structure
+ * @param sample Where to copy the sample
+ * @param size Sample size in bytes (at most s_SLOT_WORDS * 4)
+ * @return Version of the sample (0 if nothing was published yet)
+ */
+uint32_t slot_read(slot_t *slot, void *sample, unsigned int size)
+{
+	uint32_t words[s_SLOT_WORDS];
+	uint32_t seq1, seq2;
+	int i;
+
+	do {
+		seq1 = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		for(i = 0; i < s_SLOT_WORDS; i++)
+			words[i] = __atomic_load_n(&slot->data[i], __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq2 = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+	} while((seq1 & 1) || seq1 != seq2);
+
+	memcpy(sample, words, size);
+
+	return seq1 / 2;
+}
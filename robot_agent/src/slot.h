@@ -0,0 +1,38 @@
+/**
+ * @file	slot.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Lock-free single-writer slot library header file.
+ */
+
+#ifndef __SLOT_H
+#define __SLOT_H
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdint.h>
+
+/* -- Constants -- */
+#define s_SLOT_WORDS				16 // Slot capacity in 32-bit words (64 bytes)
+
+/* -- Types -- */
+
+/**
+ * @brief Single-writer slot structure (sequence lock around the latest sample)
+ */
+typedef struct s_SLOT_STRUCT
+{
+	uint32_t seq; // Even while stable, odd while the writer updates the data
+	uint32_t data[s_SLOT_WORDS]; // Latest published sample
+
+} slot_t;
+
+/* -- Function Prototypes -- */
+void slot_init(slot_t *slot); // Clear slot
+void slot_write(slot_t *slot, const void *sample, unsigned int size); // Publish sample (one writer only)
+uint32_t slot_read(slot_t *slot, void *sample, unsigned int size); // Copy latest sample, returns its version
+
+#endif /* __SLOT_H */
@@ -13,6 +13,12 @@
 
 /* project libraries */
 #include "task.h"
+#include "scheduler.h"
+#include "eventloop.h"
+#include "rt.h"
+#include "clocksync.h"
+#include "adapt.h"
+#include "pf_simd.h"
 
 /* -- Defines -- */
 
@@ -65,12 +71,53 @@ int g_go_ahead;
 
 /* -- Functions -- */
 
+/**
+ * Background job: evaluate particle filter statistics in the scheduler slack,
+ * so Control and Navigate read the accuracy instead of computing it every run
+ * @return s_FALSE (done for this cycle)
+ */
+static int task_job_pf_stats(void)
+{
+	g_pfs->accuracy = pf_accuracy(g_pfs, g_envs);
+
+	return s_FALSE;
+}
+
+/**
+ * Event loop handler: packets (commands above all) are handled as they arrive
+ * @return Void
+ */
+static void task_event_udp(void)
+{
+	task_communicate_receive();
+}
+
+/**
+ * Event loop handler: parse RFID tag frames as they arrive
+ * @return Void
+ */
+static void task_event_rfid(void)
+{
+	rfid_poll(g_rfids);
+}
+
+/**
+ * Event loop handler: drop Open Interface bytes that arrive outside a request
+ * @return Void
+ */
+static void task_event_oi(void)
+{
+	openinterface_flush(g_ois);
+}
+
 /**
  * Initialize tasks
  * @param enable If larger than 0, then enable all tasks at the start. Otherwise only Mission and Communicate tasks are enabled
  */
 void task_init(int enable)
 {
+	int i;
+
 	// Init enviroment
 	g_envs = enviroment_load(	g_config.enviroment_room_def_path,
 								g_config.enviroment_tags_def_path);
@@ -84,6 +131,14 @@ void task_init(int enable)
 
 	// Init RFID
 	g_rfids = rfid_open(g_config.serialport_rfid_port_path);
+	// Serve both serial devices from reader threads, tasks then only read memory
+	if(g_config.reader_enable)
+	{
+		if(openinterface_reader_start(g_ois, g_config.reader_oi_period) == s_ERROR)
+			printf("task_init: Open Interface is read by the tasks.\n");
+		if(rfid_reader_start(g_rfids) == s_ERROR)
+			printf("task_init: RFID is read by the tasks.\n");
+	}
 	// Init Particle filter
 	g_pfs = pf_init(g_config.pf_particles_num,
 					g_envs,
@@ -92,6 +147,8 @@ void task_init(int enable)
 					g_config.pf_noise_tag,
 					g_config.pf_noise_wall,
 					g_config.robot_radius);
+	pf_simd_init(g_config.pf_simd);
+	printf("Particle filter: %d particles, %s motion update\n", g_pfs->num, pf_simd_name());
 	// Init Robot
 	g_robot = robot_init(	g_config.robot_init_x,
 							g_config.robot_init_y,
@@ -106,6 +163,17 @@ void task_init(int enable)
 							g_config.pheromone_eval_radius,
 							g_config.pheromone_eval_dist,
 							g_config.pheromone_sector_max_size);
+	// Scale particles and pheromones with the load, starting at the configured workload
+	if(g_config.adapt_enable)
+	{
+		if(adapt_init(	g_config.adapt_target,
+						g_config.adapt_period,
+						g_config.adapt_particles_min,
+						g_config.pf_particles_num,
+						g_config.adapt_eval_step_max,
+						g_config.adapt_sectors_min) == s_ERROR)
+			printf("task_init: the workload is not adapted.\n");
+	}
 	// Init UDP
 	g_udps = udp_open(	g_config.udp_broadcast_ip,
 						g_config.udp_port,
@@ -147,6 +215,15 @@ void task_init(int enable)
 	}
 	
 
+	// All tasks start in normal (not degraded) mode
+	g_task_mission.degraded 		= s_FALSE;
+	g_task_navigate.degraded 		= s_FALSE;
+	g_task_control.degraded 		= s_FALSE;
+	g_task_refine.degraded 			= s_FALSE;
+	g_task_report.degraded 			= s_FALSE;
+	g_task_communicate.degraded 	= s_FALSE;
+	g_task_avoid.degraded 			= s_FALSE;
+
 	// Init mission data
 	g_task_mission_data.victim_count = 0;	
 	// Init the data stream counter and timer
@@ -164,8 +241,41 @@ void task_init(int enable)
 
 	//TODO:load the slot from a config file
 	g_tdma_slot=g_config.robot_id-1;
+	// Not in step with mission control until the first GO_AHEAD
+	clocksync_init();
 
 	g_go_ahead = 1;
+
+	// Touch the large arrays now, not in the first cycles of the mission
+	if(g_config.rt_enable)
+	{
+		rt_prefault(g_pfs->x, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->y, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->a, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->w, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->bx, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->by, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->ba, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->bw, g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->u, 2 * g_pfs->num_max * sizeof(float));
+		rt_prefault(g_pfs->idx, g_pfs->num_max * sizeof(int));
+		for(i = 0; i < g_phs->x_cells; i++)
+			rt_prefault(g_phs->map[i], g_phs->y_cells * sizeof(int));
+	}
+
+	// Non-urgent work runs in the slack of the scheduler
+	scheduler_add_job(task_job_pf_stats, "pf stats");
+
+	// Input is handled while the scheduler waits for the next release. Serial
+	// ports served by reader threads are left to them
+	if(g_config.scheduler_event_loop && eventloop_init() == s_OK)
+	{
+		eventloop_add(g_udps->sd_recv, task_event_udp, "udp");
+		if(!g_rfids->reader_run && eventloop_add(g_rfids->sps->descriptor, task_event_rfid, "rfid") == s_OK)
+			rfid_poll_start(g_rfids);
+		if(!g_ois->reader_run && eventloop_add(g_ois->sps->descriptor, task_event_oi, "oi") == s_OK)
+			serialport_nonblock(g_ois->sps);
+	}
 }
 
 /**
@@ -173,6 +283,8 @@ void task_init(int enable)
  */
 void task_destroy(void)
 {
+	// Stop watching the descriptors before they are closed
+	eventloop_destroy();
 	// Deinit enviroment
 	enviroment_destroy(g_envs);
 	// Deinit open interface
@@ -38,19 +38,19 @@
 /* -- Enumerations -- */
 
 /* Time between victim found and message sent */
-struct timeval notify_victim_time;
+extern timelib_ns_t notify_victim_time;
 /* Time between STOP cmd and motors STOP */
-struct timeval motors_stop_time;
+extern timelib_ns_t motors_stop_time;
 // Counter with the number of times the communication task tries to run
 // without having received a go_ahead. Extern since it's defined in scheduler.c
-cnt_t illegal_communications;
+extern cnt_t illegal_communications;
 // Counter with the total number of times the communication task runs.
 // Extern since it's defined in scheduler.c
-cnt_t total_communications;
+extern cnt_t total_communications;
 // Counter with total victims read
-cnt_t total_victims;
+extern cnt_t total_victims;
 // Counter with victims whose location was not accurate
-cnt_t inaccurate_victims;
+extern cnt_t inaccurate_victims;
 // Counter with all desired data to send, according to types
 extern cnt_t total_data_count[4];
 // Counter with actual data sent
@@ -65,6 +65,7 @@ extern double victim_offset_average;
 typedef struct s_TASK_STRUCT
 {
 	int enabled;
+	int degraded; // Set by the overload manager: skip optional work
 
 } task_t;
 
@@ -79,10 +80,10 @@ typedef struct s_TASK_MISSION_STRUCT
 
 	// Stream
 	long stream_counter;
-	struct timeval stream_timer;
+	timelib_ns_t stream_timer;
 
 	// Go ahead
-	struct timeval go_ahead_timer;
+	timelib_ns_t go_ahead_timer;
 
 } task_mission_t;
 
@@ -92,7 +93,7 @@ typedef struct s_TASK_MISSION_STRUCT
 typedef struct s_TASK_CONTROL_STRUCT
 {
 	// OpenInterface request timer
-	struct timeval request_timer;
+	timelib_ns_t request_timer;
 
 } task_control_t;
 
@@ -199,11 +200,13 @@ void task_destroy(void); // Deinitialize tasks
 
 /* Tasks */
 void task_mission(void); // Control mission
+void task_mission_command(int cmd); // Apply mission command at once
 void task_navigate(void); // Control navigation
 void task_control(void); // Sense, control, localization
 void task_avoid(void); // Check the bump sensors for collision
 void task_refine(void); // Refine position, localization
 void task_report(void); // Report victim
 void task_communicate(void); // Communication (receive and send data)
+void task_communicate_receive(void); // Receive, decode and forward waiting packets
 
 #endif /* __TASK_H */
@@ -13,6 +13,7 @@
 
 /* project libraries */
 #include "task.h"
+#include "rng.h"
 
  /**
  * Check the bump sensors for collision
@@ -48,7 +49,7 @@ void task_avoid(void)
 		// Center Bump
 		else if(g_ois->oiss->wheeldrop_bump == 3)
 		{
-			if((rand() % 10) > 5)
+			if(rng_int(s_RNG_STREAM_NAVIGATE, 10) > 5)
 				openinterface_drive(g_ois, g_config.robot_speed, 0xFFFF);
 			else
 				openinterface_drive(g_ois, g_config.robot_speed, 0x0001);
@@ -14,6 +14,8 @@
 #include <math.h>
 /* project libraries */
 #include "task.h"
+#include "clocksync.h"
+#include "tdma.h"
 
 static unsigned packets_sent = 0;
 static unsigned max_allowed_packets = 10;
@@ -34,9 +36,6 @@ void task_communicate(void)
         char udp_packet[g_config.udp_packet_size];
         int udp_packet_len;
 
-        // Protocol
-        protocol_t packet;
-
         //Start the new sequence
         int seq = 0; // Massi thing
         //In principle I want to send all the data in the buffer
@@ -159,7 +158,7 @@ void task_communicate(void)
                 {
                     //Stop timer defined in task.h
                     printf("[Req.2] Time elapsed between victim found and message sent: %f ms\n",
-                            timelib_timer_get(notify_victim_time));
+                            timelib_timer_get(notify_victim_time) / 1e6);
                     already_printed = 1;
                 }
             }
@@ -277,93 +276,112 @@ void task_communicate(void)
         packets_sent = 0;
 
         /* --- Receive Data --- */
-        // Receive packets, decode and forward to proper process
+        // Normally the event loop already received everything as it arrived
+        task_communicate_receive();
 
-        // Receive UDP packet
-        while(udp_receive(g_udps, udp_packet, &udp_packet_len) == s_OK)
+        // Increase msg sequance id
+        g_message_sequence_id++;
+    }
+}
+
+/**
+ * Receive packets, decode and forward them to the proper task. Called by
+ * task_communicate() and by the event loop as soon as the socket is readable,
+ * so commands (GO_AHEAD, START, STOP) take effect without waiting for the
+ * TDMA slot of this robot
+ */
+void task_communicate_receive(void)
+{
+    // UDP Packet (one more byte for the string end)
+    char udp_packet[g_config.udp_packet_size + 1];
+    int udp_packet_len;
+
+    // Protocol
+    protocol_t packet;
+
+    // Receive UDP packets until none is waiting
+    while(udp_poll(g_udps, udp_packet, &udp_packet_len) == s_OK)
+    {
+        // Robots of every team on the channel share the TDMA slots, count
+        // the sender before the team filter of protocol_decode
+        if(protocol_decode_header(&packet, udp_packet) == s_OK)
+            tdma_heard(packet.send_id);
+
+        // Decode packet
+        //printf("%s\n",udp_packet);
+        if(protocol_decode(&packet, udp_packet, udp_packet_len, g_config.robot_id, g_config.robot_team) == s_OK)
         {
-            // Decode packet
-            //printf("%s\n",udp_packet);
-            if(protocol_decode(&packet, udp_packet, udp_packet_len, g_config.robot_id, g_config.robot_team) == s_OK)
+            // Now decoding depends on the type of the packet
+            switch(packet.type)
             {
-                // Now decoding depends on the type of the packet
-                switch(packet.type)
-                {
-                    // ACK
-                    case s_PROTOCOL_TYPE_ACK :
-                        // Do nothing
-                        break;
-
-                        //Massi: go_ahead packet
-                    case s_PROTOCOL_TYPE_GO_AHEAD :
-                        {
-                            // Declare go ahead command
-                            command_t go_ahead;
-                            go_ahead.cmd = s_CMD_GO_AHEAD;
-                            // Redirect to mission by adding it to the queue
-                            queue_enqueue(g_queue_mission, &go_ahead, s_DATA_STRUCT_TYPE_CMD);
+                // ACK
+                case s_PROTOCOL_TYPE_ACK :
+                    // Do nothing
+                    break;
 
-                            // Debuging stuff
-                            debug_printf("GO_AHEAD RECEIVED for robot %d team %d\n",packet.recv_id,packet.send_team);
-                            // Calculate time from packet (ms and s)
-                            int send_time_s = floor(packet.send_time / 1000);
-                            int send_time_ms = packet.send_time % 1000;
-                            int now = floor(((long long)timelib_unix_timestamp() % 60000) / 1000);
-                            debug_printf("GO_AHEAD_TIME: %d (%d)\n",send_time_s,now);
+                    //Massi: go_ahead packet
+                case s_PROTOCOL_TYPE_GO_AHEAD :
+                    {
+                        // Apply at once instead of queueing it for the mission task
+                        task_mission_command(s_CMD_GO_AHEAD);
+                        // Its time stamp keeps our TDMA slot in step with mission control
+                        clocksync_sample(packet.send_time);
 
-                            break;
-                        }
-                        // Data
-                    case s_PROTOCOL_TYPE_DATA :
-                        // Continue depending on the data type
-                        switch(packet.data_type)
-                        {
-                            // Robot pose
-                            case s_DATA_STRUCT_TYPE_ROBOT :
-                                debug_printf("received robot\n");
-                                // Do nothing
-                                break;
-                                // Victim information
-                            case s_DATA_STRUCT_TYPE_VICTIM :
-                                debug_printf("received victim\n");
-                                // Redirect to mission by adding it to the queue
-                                queue_enqueue(g_queue_mission, packet.data, s_DATA_STRUCT_TYPE_VICTIM);
-                                break;
-                                // Pheromone map
-                            case s_DATA_STRUCT_TYPE_PHEROMONE :
-                                debug_printf("received pheromone\n");
-                                // Redirect to navigate by adding it to the queue
-                                queue_enqueue(g_queue_navigate, packet.data, s_DATA_STRUCT_TYPE_PHEROMONE);
+                        // Debuging stuff
+                        debug_printf("GO_AHEAD RECEIVED for robot %d team %d\n",packet.recv_id,packet.send_team);
+                        // Calculate time from packet (ms and s)
+                        int send_time_s = floor(packet.send_time / 1000);
+                        int now = (int)(timelib_wall_ms() % 60000 / 1000);
+                        debug_printf("GO_AHEAD_TIME: %d (%d)\n",send_time_s,now);
 
-                                break;
-                                // Command
-                            case s_DATA_STRUCT_TYPE_CMD :
-                                debug_printf("received CMD\n");
-                                // Redirect to mission by adding it to the queue
-                                queue_enqueue(g_queue_mission, packet.data, s_DATA_STRUCT_TYPE_CMD);
-                                break;
-                            case s_DATA_STRUCT_TYPE_STREAM :
-                                debug_printf("received data stream item\n");
-                                break;
-                                // Other
-                            default :
-                                // Do nothing
-                                break;
-                        }
-                        // Other ?
-                    default:
-                        // Do nothing
                         break;
-                }
+                    }
+                    // Data
+                case s_PROTOCOL_TYPE_DATA :
+                    // Continue depending on the data type
+                    switch(packet.data_type)
+                    {
+                        // Robot pose
+                        case s_DATA_STRUCT_TYPE_ROBOT :
+                            debug_printf("received robot\n");
+                            // Do nothing
+                            break;
+                            // Victim information
+                        case s_DATA_STRUCT_TYPE_VICTIM :
+                            debug_printf("received victim\n");
+                            // Redirect to mission by adding it to the queue
+                            queue_enqueue(g_queue_mission, packet.data, s_DATA_STRUCT_TYPE_VICTIM);
+                            break;
+                            // Pheromone map
+                        case s_DATA_STRUCT_TYPE_PHEROMONE :
+                            debug_printf("received pheromone\n");
+                            // Redirect to navigate by adding it to the queue
+                            queue_enqueue(g_queue_navigate, packet.data, s_DATA_STRUCT_TYPE_PHEROMONE);
 
-                // Free memory (only if data packet was received!)
-                if(packet.type == s_PROTOCOL_TYPE_DATA)
-                    free(packet.data);
+                            break;
+                            // Command
+                        case s_DATA_STRUCT_TYPE_CMD :
+                            debug_printf("received CMD\n");
+                            // Apply at once (STOP must reach the motors quickly)
+                            task_mission_command(((command_t *)packet.data)->cmd);
+                            break;
+                        case s_DATA_STRUCT_TYPE_STREAM :
+                            debug_printf("received data stream item\n");
+                            break;
+                            // Other
+                        default :
+                            // Do nothing
+                            break;
+                    }
+                    // Other ?
+                default:
+                    // Do nothing
+                    break;
             }
-        }
 
-        // Increase msg sequance id
-        g_message_sequence_id++;
+            // Free memory (only if data packet was received!)
+            if(packet.type == s_PROTOCOL_TYPE_DATA)
+                free(packet.data);
+        }
     }
 }
-
@@ -13,6 +13,7 @@
 
 /* project libraries */
 #include "task.h"
+#include "adapt.h"
 
 static unsigned first_time = 1;
 
@@ -30,14 +31,19 @@ void task_control(void)
         // Reset first time variable
         first_time = 1;
 
+		// Number of particles set by the workload controller (configured number if it is off)
+		if(adapt_running())
+			pf_set_num(g_pfs, adapt_particles());
+
 		// Update sensors Odometer
 #ifndef s_CONFIG_TEST_ENABLE
 		// Request only if the allowed period has passed
-		req_time = (int)timelib_timer_get(g_task_control_data.request_timer);
+		req_time = (int)timelib_timer_get_ms(g_task_control_data.request_timer);
 		if(req_time > s_CONFIG_OI_REQUEST_PERIOD)
 		{
-			openinterface_sensors_update(g_ois, s_OI_SENSOR_PACKET_2, s_OI_SENSOR_PACKET_2_SIZE);
-			pf_drive(g_pfs, g_ois->oiss->distance, g_ois->oiss->angle, 0);
+			// Odometry is relative to the last reply, a failed request must not move the particles again
+			if(openinterface_sensors_update(g_ois, s_OI_SENSOR_PACKET_2, s_OI_SENSOR_PACKET_2_SIZE) == s_OK)
+				pf_drive(g_pfs, g_ois->oiss->distance, g_ois->oiss->angle, 0);
 			timelib_timer_reset(&g_task_control_data.request_timer);
 		}
 		else
@@ -52,7 +58,8 @@ void task_control(void)
 		// Motion Update (Particle filter)
 		pf_estimate(g_pfs, g_robot);
 
-		if(pf_accuracy(g_pfs, g_envs) < s_CONFIG_ACCURACY_LIMIT)
+		// Accuracy is evaluated in the scheduler slack (see task_job_pf_stats)
+		if(g_pfs->accuracy < s_CONFIG_ACCURACY_LIMIT)
 		{
 			speed = g_config.robot_speed / 2;
 		}
@@ -113,7 +120,7 @@ void task_control(void)
         if (first_time)
         {
             printf("[Req.3] Motors stopped after %f milliseconds\n",
-                    timelib_timer_get(motors_stop_time));
+                    timelib_timer_get(motors_stop_time) / 1e6);
             first_time = 0;
         }
     }
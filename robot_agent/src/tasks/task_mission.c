@@ -16,6 +16,62 @@
 /* project libraries */
 #include "task.h"
 
+/**
+ * Apply mission command at once (queued commands and commands received by
+ * the event loop both end up here)
+ * @param cmd Command (s_CMD_*)
+ */
+void task_mission_command(int cmd)
+{
+	// Choose action depending on command
+	switch(cmd)
+	{
+	// Start tasks
+	case s_CMD_START :
+		printf("Start command received\n");
+		g_task_mission.enabled 			= s_TRUE;
+		g_task_navigate.enabled 		= s_TRUE;
+		g_task_control.enabled 			= s_TRUE;
+		g_task_refine.enabled 			= s_TRUE;
+		g_task_report.enabled 			= s_TRUE;
+		g_task_communicate.enabled 		= s_TRUE;
+		g_task_avoid.enabled 			= s_TRUE;
+
+		debug_printf("cmd start\n");
+
+		break;
+	// Stop tasks
+	case s_CMD_STOP :
+		printf("[Req.3] Stop command received\n");
+		timelib_timer_set(&motors_stop_time);
+
+		g_task_mission.enabled 			= s_TRUE;
+		g_task_navigate.enabled 		= s_FALSE;
+		g_task_control.enabled 			= s_FALSE;
+		g_task_avoid.enabled 			= s_FALSE;
+		g_task_refine.enabled 			= s_FALSE;
+		g_task_report.enabled 			= s_FALSE;
+		g_task_communicate.enabled 		= s_TRUE;
+
+		debug_printf("cmd stop\n");
+
+		// Get full control over robot
+		openinterface_drive(g_ois, 0, 0x8000);
+		printf("[Req.3] Gained control over motors after %f milliseconds\n",
+			timelib_timer_get(motors_stop_time) / 1e6);
+		break;
+	case s_CMD_GO_AHEAD :
+		// Go Ahead received
+		g_go_ahead = 1;
+		timelib_timer_reset(&g_task_mission_data.go_ahead_timer);
+		break;
+	// Other
+	default :
+		// Do nothing
+		break;
+	}
+}
+
 /**
  * Control mission
  */
@@ -28,12 +84,12 @@ void task_mission(void)
 		int i, j;
 		void *data; // Void pointer for data
 		int data_type; // Data type
-		int stream_time, stream_time_reminder, stream_packet_count; // Stream time to be sent
+		int stream_packet_count; // Stream packets due since the last run
 		int go_ahead_time; // Go ahead time passed
 		stream_t stream;
 
 		// -- Check go ahead timer --
-		go_ahead_time = (int)timelib_timer_get(g_task_mission_data.go_ahead_timer);
+		go_ahead_time = (int)timelib_timer_get_ms(g_task_mission_data.go_ahead_timer);
 
 		if(go_ahead_time > s_CONFIG_GO_AHEAD_TIME)
 		{
@@ -90,53 +146,8 @@ void task_mission(void)
 			// Command
 			case s_DATA_STRUCT_TYPE_CMD :
 
-				// Choose action depending on command
-				switch(((command_t *)data)->cmd)
-				{
-				// Start tasks
-				case s_CMD_START :
-                    printf("Start command received\n");
-					g_task_mission.enabled 			= s_TRUE;
-					g_task_navigate.enabled 		= s_TRUE;
-					g_task_control.enabled 			= s_TRUE;
-					g_task_refine.enabled 			= s_TRUE;
-					g_task_report.enabled 			= s_TRUE;
-					g_task_communicate.enabled 		= s_TRUE;
-					g_task_avoid.enabled 			= s_TRUE;
-
-                    debug_printf("cmd start\n");
-
-					break;
-				// Stop tasks
-				case s_CMD_STOP :
-                    printf("[Req.3] Stop command received\n");
-                    timelib_timer_set(&motors_stop_time);
-
-					g_task_mission.enabled 			= s_TRUE;
-					g_task_navigate.enabled 		= s_FALSE;
-					g_task_control.enabled 			= s_FALSE;
-					g_task_avoid.enabled 			= s_FALSE;
-					g_task_refine.enabled 			= s_FALSE;
-					g_task_report.enabled 			= s_FALSE;
-					g_task_communicate.enabled 		= s_TRUE;
-
-					debug_printf("cmd stop\n");
-
-					// Get full control over robot
-					openinterface_drive(g_ois, 0, 0x8000);
-                    printf("[Req.3] Gained control over motors after %f milliseconds\n",
-                            timelib_timer_get(motors_stop_time));
-					break;
-				case s_CMD_GO_AHEAD :
-					// Go Ahead received
-					g_go_ahead = 1;
-					timelib_timer_reset(&g_task_mission_data.go_ahead_timer);
-					break;
-				// Other
-				default :
-					// Do nothing
-					break;
-				}
+				// Apply command
+				task_mission_command(((command_t *)data)->cmd);
 
 				break;
 			// Other
@@ -175,14 +186,17 @@ void task_mission(void)
 		}
 
 		// -- Generate stream data --
-		// Get time for stream
-		stream_time = (int)timelib_timer_reset(&g_task_mission_data.stream_timer);
-		stream_packet_count = (int)(stream_time / (1000 / (float)s_CONFIG_STREAM_RATE));
-
-		//stream_time_reminder = (int)fmod(stream_time, (1000 / (float)s_CONFIG_STREAM_RATE)); // Calculate reminder not to loose miliseconds
-		//timelib_timer_add_ms(&g_task_mission_data.stream_timer, stream_time_reminder); // Add them back
+		// One packet per stream period that passed, the part of a period
+		// left over stays in the timer for the next run
+		stream_packet_count = (int)timelib_timer_advance(&g_task_mission_data.stream_timer,
+			s_TIMELIB_NS_PER_S / s_CONFIG_STREAM_RATE);
+		// Under overload the stream is shed (packets of that time are dropped, not delayed)
+		if(g_task_mission.degraded == s_TRUE)
+		{
+			stream_packet_count = 0;
+		}
 
-		//debug_printf("STREAM: %d, %d\n", stream_time, stream_packet_count);
+		//debug_printf("STREAM: %d\n", stream_packet_count);
 
 		// Generate and send stream
 		for(i = 0; i < stream_packet_count; i++)
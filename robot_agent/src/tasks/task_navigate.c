@@ -13,6 +13,11 @@
 
 /* project libraries */
 #include "task.h"
+#include "trace.h"
+#include "adapt.h"
+
+static int sector_next = 0; // First sector of the next broadcast (if not all are sent)
+static int extract_ready = s_FALSE; // A complete pass of the extraction waits in the send list
 
  /**
  * Control navigation
@@ -23,7 +28,7 @@ void task_navigate(void)
 	if(g_task_navigate.enabled == s_TRUE)
 	{
 		// Local vaiables
-		int i;
+		int i, n, runs;
 		void *data; // Void pointer for data
 		int data_type; // Data type
 
@@ -52,27 +57,53 @@ void task_navigate(void)
 		}
 
 		// Put pheromone only of position is reasonably accurate 
-		if(pf_accuracy(g_pfs, g_envs) > s_CONFIG_ACCURACY_LIMIT)
+		if(g_pfs->accuracy > s_CONFIG_ACCURACY_LIMIT)
 		{
 			pheromone_put(g_phs, g_robot->x, g_robot->y);
 		}
 
 
 
-		// Extract Pheromone map into sectors
-		pheromone_map_sector_t **phms = pheromone_map_extract(g_phs);
-		// Send pheromone map sectors (add data to communication queue)
-		for(i = 0; i < g_phs->sector_count; i++)
+		// Extract and broadcast Pheromone map (skipped under overload,
+		// the local map is still updated and used to decide the next move).
+		// Communicate sends the map once per period, so the extraction is
+		// spread over the Navigate runs in between: a few sectors per run,
+		// starting after the last broadcast and done one run before the next
+		if(extract_ready == s_TRUE && g_list_send_pheromones->count == 0)
+		{
+			extract_ready = s_FALSE;
+		}
+		if(g_task_navigate.degraded == s_FALSE && extract_ready == s_FALSE)
 		{
-// 			doublylinkedlist_insert_end(g_list_send, phms[i], s_DATA_STRUCT_TYPE_PHEROMONE);
-            doublylinkedlist_insert_end(g_list_send_pheromones, phms[i], s_DATA_STRUCT_TYPE_PHEROMONE);
+			runs = g_config.tasks[s_TASK_COMMUNICATE_ID].period / g_config.tasks[s_TASK_NAVIGATE_ID].period - 1;
+			if(runs < 1)
+				runs = 1;
+			n = (g_phs->sector_count + runs - 1) / runs;
+
+			// Refresh the next sectors of the pheromone map
+			trace_event(s_TRACE_EVENT_EXTRACT_BEGIN, 0, 0);
+			extract_ready = pheromone_map_extract_step(g_phs, n);
+			trace_event(s_TRACE_EVENT_EXTRACT_END, 0, n);
+
+			// Send pheromone map sectors once the pass is complete (add data to
+			// communication queue). Under load only some sectors are sent, the
+			// next ones after the following pass
+			if(extract_ready == s_TRUE)
+			{
+				n = adapt_sectors(g_phs->sector_count);
+				for(i = 0; i < n; i++)
+				{
+					doublylinkedlist_insert_end(g_list_send_pheromones, &g_phs->sectors[(sector_next + i) % g_phs->sector_count], s_DATA_STRUCT_TYPE_PHEROMONE);
+				}
+				sector_next = (sector_next + n) % g_phs->sector_count;
+			}
 		}
-		// Free memory
-		pheromone_map_destroy(g_phs, phms);
 
 		//Massi:check the go_ahead
 		if(g_go_ahead){
-			// Decide next move and send it to control
+			// Decide next move and send it to control, at the smell resolution
+			// set by the workload controller
+			g_phs->eval_step = adapt_eval_step();
 			g_tp_navigate_control.move = pheromone_eval(g_phs, g_robot);
 
 		}else{
@@ -94,7 +94,7 @@ void task_refine(void)
 		{
             // Victim found: start timer
             printf("[Req.2] Victim was found!\n");
-            gettimeofday(&notify_victim_time, NULL);
+            timelib_timer_set(&notify_victim_time);
 			// Redirect to task_report()
 			// Copy ID to pipe
 			strncpy(g_tp_refine_report.victim_id, g_rfids->id, 11);
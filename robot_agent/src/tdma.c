@@ -0,0 +1,196 @@
+/**
+ * @file	tdma.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Dynamic TDMA slot allocation library. A TDMA period (network tdma_period)
+ * has tdma_slot_num slots. When more robots share the channel than there
+ * are slots, a superframe of several periods gives every robot one slot.
+ *
+ * There is no negotiation message: every robot knows the robots it heard
+ * from within the last s_TDMA_TIMEOUT superframes and sorts them by ID. The
+ * rank of a robot in that list is its slot, so all robots that heard the
+ * same fleet agree on the allocation. Slots are reallocated as soon as a
+ * robot is heard for the first time or times out.
+ *
+ * Slots are placed on the clock of mission control (our wall clock corrected
+ * by the clock synchronisation), so that all robots use the same grid.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <math.h>
+/* project libraries */
+#include "tdma.h"
+#include "clocksync.h"
+#include "timelib.h"
+#include "protocol.h"
+
+/* -- Global Variables -- */
+static int tdma_robot_id = 0; // Our robot ID
+static int tdma_slot_num = 0; // Slots in a TDMA period
+static int tdma_period = 0; // TDMA period (ms)
+static struct timespec tdma_heard_ts[s_TDMA_ROBOT_MAX]; // Last packet of every robot (monotonic)
+static int tdma_member[s_TDMA_ROBOT_MAX]; // Robot is on the channel (s_TRUE/s_FALSE)
+static int tdma_robots = 1; // Robots on the channel
+static int tdma_slot = 0; // Our slot in the superframe
+static int tdma_superframe = 1; // Periods in a superframe
+static cnt_t tdma_reallocations = 0; // Allocation changes
+static cnt_t tdma_slots_used = 0; // Slots we were dispatched in
+
+/* -- Functions -- */
+
+/**
+ * Compute our slot and the superframe length from the robots on the channel
+ * @return Void
+ */
+static void tdma_allocate(void)
+{
+	int i, rank = 0, robots = 0;
+
+	for(i = 0; i < s_TDMA_ROBOT_MAX; i++)
+	{
+		if(!tdma_member[i])
+			continue;
+		if(i < tdma_robot_id)
+			rank++;
+		robots++;
+	}
+
+	if(robots == tdma_robots && rank == tdma_slot)
+		return;
+
+	tdma_robots = robots;
+	tdma_slot = rank;
+	tdma_superframe = (robots + tdma_slot_num - 1) / tdma_slot_num;
+	tdma_reallocations++;
+	printf("[TDMA] %d robots on the channel: slot %d of %d (superframe %d x %d ms)\n",
+		tdma_robots, tdma_slot, tdma_superframe * tdma_slot_num, tdma_superframe, tdma_period);
+}
+
+/**
+ * Drop robots not heard for s_TDMA_TIMEOUT superframes
+ * @param now Current time (monotonic)
+ * @return Void
+ */
+static void tdma_expire(const struct timespec *now)
+{
+	int i, changed = s_FALSE;
+	long long timeout = (long long)s_TDMA_TIMEOUT * tdma_superframe * tdma_period * 1000;
+
+	for(i = 0; i < s_TDMA_ROBOT_MAX; i++)
+	{
+		if(!tdma_member[i] || i == tdma_robot_id)
+			continue;
+		if(timelib_timespec_diff_us(tdma_heard_ts[i], *now) > timeout) {
+			tdma_member[i] = s_FALSE;
+			changed = s_TRUE;
+		}
+	}
+
+	if(changed)
+		tdma_allocate();
+}
+
+/**
+ * Start as the only robot on the channel
+ * @param robot_id Our robot ID
+ * @param slot_num Slots in a TDMA period
+ * @param period TDMA period (ms)
+ * @return s_OK if successful, s_ERROR if the settings can not be used
+ */
+int tdma_init(int robot_id, int slot_num, int period)
+{
+	int i;
+
+	if(robot_id < 0 || robot_id >= s_TDMA_ROBOT_MAX || slot_num <= 0 || period < slot_num) {
+		printf("tdma_init: robot %d, %d slots in %d ms can not be allocated.\n", robot_id, slot_num, period);
+		return s_ERROR;
+	}
+
+	tdma_robot_id = robot_id;
+	tdma_slot_num = slot_num;
+	tdma_period = period;
+	for(i = 0; i < s_TDMA_ROBOT_MAX; i++)
+		tdma_member[i] = s_FALSE;
+	tdma_member[robot_id] = s_TRUE;
+	tdma_robots = 0;
+	tdma_reallocations = 0;
+	tdma_slots_used = 0;
+	tdma_allocate();
+
+	return s_OK;
+}
+
+/**
+ * Note a packet from another robot (reallocates if it is new on the channel).
+ * Mission control and broadcast senders are not robots and hold no slot
+ * @param robot_id Sender robot ID
+ * @return Void
+ */
+void tdma_heard(int robot_id)
+{
+	if(tdma_slot_num == 0 || robot_id < 0 || robot_id >= s_TDMA_ROBOT_MAX || robot_id == tdma_robot_id
+		|| robot_id == s_PROTOCOL_ADDR_SERVER || robot_id == s_PROTOCOL_ADDR_BROADCAST)
+		return;
+
+	timelib_clock_gettime(&tdma_heard_ts[robot_id]);
+	if(!tdma_member[robot_id]) {
+		tdma_member[robot_id] = s_TRUE;
+		tdma_allocate();
+	}
+}
+
+/**
+ * Check if a minor cycle is the first one that starts in our slot. The slot
+ * must be at least a minor cycle long, so that every slot has one
+ * @param release Release of the minor cycle (monotonic)
+ * @param minor Minor cycle (ms)
+ * @return s_TRUE if so, s_FALSE otherwise
+ */
+int tdma_slot_due(const struct timespec *release, unsigned int minor)
+{
+	struct timespec ts_now;
+	double t, start;
+	long long index;
+
+	if(tdma_slot_num == 0)
+		return s_FALSE;
+
+	timelib_clock_gettime(&ts_now);
+	tdma_expire(&ts_now);
+
+	// Release on the clock of mission control
+	t = (double)timelib_wall_now() / s_TIMELIB_NS_PER_MS + clocksync_offset_ms() + timelib_timespec_diff_us(ts_now, *release) / 1000.0 + s_TDMA_EARLY;
+
+	// Latest start of our slot (position in its period) before the release
+	index = (long long)floor(t / tdma_period);
+	start = (double)index * tdma_period + (double)(tdma_slot % tdma_slot_num) * tdma_period / tdma_slot_num;
+	if(start > t) {
+		index--;
+		start -= tdma_period;
+	}
+
+	// Our period of the superframe, and the first release in the slot
+	if(index % tdma_superframe != tdma_slot / tdma_slot_num || t - start >= minor)
+		return s_FALSE;
+
+	tdma_slots_used++;
+	return s_TRUE;
+}
+
+/**
+ * Print slot allocation
+ * @return Void
+ */
+void tdma_dump_statistics(void)
+{
+	if(tdma_slot_num == 0)
+		return;
+
+	printf("TDMA slot:\t\t\tslot %d of %d, %d robots, %llu allocations, used %llu times\n",
+		tdma_slot, tdma_superframe * tdma_slot_num, tdma_robots, tdma_reallocations, tdma_slots_used);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file	tdma.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Dynamic TDMA slot allocation library header file.
+ */
+
+#ifndef __TDMA_H
+#define __TDMA_H
+
+/* -- Includes -- */
+/* system libraries */
+#include <time.h>
+/* project libraries */
+#include "def.h"
+
+/* -- Constants -- */
+#define s_TDMA_ROBOT_MAX				64 // Robot IDs 0 .. s_TDMA_ROBOT_MAX - 1 take part
+#define s_TDMA_TIMEOUT					3 // Superframes without a packet after which a robot has left
+#define s_TDMA_EARLY					1 // A release this close before the slot counts as in the slot (ms)
+
+/* -- Function Prototypes -- */
+int tdma_init(int robot_id, int slot_num, int period); // Start as the only robot on the channel
+void tdma_heard(int robot_id); // Note a packet from another robot
+int tdma_slot_due(const struct timespec *release, unsigned int minor); // Check if the minor cycle is the first in our slot
+void tdma_dump_statistics(void); // Print slot allocation
+
+#endif /* __TDMA_H */
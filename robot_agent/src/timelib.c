@@ -11,128 +11,203 @@
 /* -- Includes -- */
 /* system libraries */
 #include <stdio.h>
-#include <sys/time.h>
+#include <errno.h>
+#include <time.h>
 /* project libraries */
 #include "timelib.h"
 
 /* -- Defines -- */
 
+/* -- Global Variables -- */
+int g_timelib_source = s_TIMELIB_CLOCK_REAL; // Clock source
+timelib_ns_t g_timelib_virtual_now = 0; // Virtual monotonic time, only moved by sleeping
+
 /* -- Functions -- */
 
+/**
+ * Select clock source. The virtual clock starts at zero (monotonic) and
+ * s_TIMELIB_VIRTUAL_EPOCH (wall-clock) and stands still until somebody sleeps,
+ * so a run depends only on its inputs and not on how fast the host is. It is
+ * not locked, only one thread may sleep on it
+ * @param source s_TIMELIB_CLOCK_REAL or s_TIMELIB_CLOCK_VIRTUAL
+ * @return Void
+ */
+void timelib_clock_init(int source)
+{
+	g_timelib_source = source;
+	g_timelib_virtual_now = 0;
+}
 
 /**
- * Set timer value
- * @param timeval structure
- * @return ... error???
+ * Check if the virtual clock is used
+ * @return 1 if virtual, 0 if real
  */
-int timelib_timer_set(struct timeval *tv)
+int timelib_clock_virtual(void)
 {
-	// Set time to now
-	gettimeofday(tv, NULL);
+	return g_timelib_source == s_TIMELIB_CLOCK_VIRTUAL;
+}
 
-	// Check error!!!
+/**
+ * Get monotonic time (CLOCK_MONOTONIC or virtual) as timespec, for
+ * absolute sleeps
+ * @param ts Timespec structure
+ * @return Void
+ */
+void timelib_clock_gettime(struct timespec *ts)
+{
+	if(g_timelib_source == s_TIMELIB_CLOCK_VIRTUAL)
+		timelib_ns_to_timespec(g_timelib_virtual_now, ts);
+	else
+		clock_gettime(CLOCK_MONOTONIC, ts);
+}
 
-	return 0;
+/**
+ * Get wall-clock time in seconds
+ * @return Seconds since the epoch
+ */
+time_t timelib_time(void)
+{
+	return (time_t)(timelib_wall_now() / s_TIMELIB_NS_PER_S);
 }
 
 /**
- * Get elapsed time in miliseconds
- * @param timeval structure
- * @return elapsed time in miliseconds
+ * Sleep until monotonic time, the virtual clock jumps there instead
+ * @param ts Absolute time (as returned by timelib_clock_gettime())
+ * @return Void
  */
-double timelib_timer_get(struct timeval tv)
+void timelib_sleep_until(const struct timespec *ts)
 {
-	struct timeval tv_now;
-	double time_elapsed;
+	timelib_ns_t until;
 
-	// Get current time
-	gettimeofday(&tv_now, NULL);
+	if(g_timelib_source == s_TIMELIB_CLOCK_VIRTUAL)
+	{
+		// Time never goes back, a release in the past is just late
+		until = timelib_timespec_to_ns(ts);
+		if(until > g_timelib_virtual_now)
+			g_timelib_virtual_now = until;
+		return;
+	}
 
-	time_elapsed = (tv_now.tv_sec - tv.tv_sec) * 1000.0;        // sec to ms
-	time_elapsed += (tv_now.tv_usec - tv.tv_usec) / 1000.0;     // us to ms
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, ts, NULL) == EINTR)
+		;
+}
 
-	// Check error!!!
+/**
+ * Sleep for microseconds, the virtual clock advances instead
+ * @param us Microseconds
+ * @return Void
+ */
+void timelib_sleep_us(unsigned int us)
+{
+	struct timespec ts;
 
-	return time_elapsed;
+	timelib_ns_to_timespec(timelib_now() + (timelib_ns_t)us * s_TIMELIB_NS_PER_US, &ts);
+	timelib_sleep_until(&ts);
 }
 
 /**
- * Reset timer value
- * @param timeval structure
- * @return elapsed time in miliseconds
+ * Get elapsed time and restart the timer from the same clock reading
+ * @param timer Timer
+ * @return Elapsed nanoseconds
  */
-double timelib_timer_reset(struct timeval *tv)
+timelib_ns_t timelib_timer_reset(timelib_ns_t *timer)
 {
-	struct timeval tv_now;
-	double time_elapsed;
+	timelib_ns_t now = timelib_now();
+	timelib_ns_t elapsed = now - *timer;
 
-	// Get current time
-	gettimeofday(&tv_now, NULL);
+	*timer = now;
 
-	time_elapsed = (tv_now.tv_sec - tv->tv_sec) * 1000.0;        // sec to ms
-	time_elapsed += (tv_now.tv_usec - tv->tv_usec) / 1000.0;     // us to ms
+	return elapsed;
+}
 
-	// Set current time to timeval
-	*tv = tv_now;
+/**
+ * Count the whole periods elapsed since the timer and move the timer
+ * forward by exactly that many periods, so the remainder is kept for the
+ * next call instead of being lost
+ * @param timer Timer
+ * @param period Period (ns, larger than 0)
+ * @return Number of whole periods
+ */
+long long timelib_timer_advance(timelib_ns_t *timer, timelib_ns_t period)
+{
+	long long ticks = (timelib_now() - *timer) / period;
 
-	// Check error!!!
+	if(ticks < 0)
+		return 0;
+	*timer += ticks * period;
 
-	return time_elapsed;
+	return ticks;
 }
 
-
 /**
- * Add time to timer in milliseconds
- * @param timeval Timeval structure
- * @param int Milliseconds to add
+ * Add time to timespec in milliseconds
+ * @param ts Timespec structure
+ * @param ms Milliseconds to add
  * @return Void
  */
-void timelib_timer_add_ms(struct timeval *tv, unsigned int ms)
+void timelib_timespec_add_ms(struct timespec *ts, unsigned int ms)
 {
 	// Increase time
-	tv->tv_usec = tv->tv_usec + (ms * 1000);
-	// Normalize tv_usec if required
-	if(tv->tv_usec >= 1000000)
+	ts->tv_sec += ms / 1000;
+	ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+	// Normalize tv_nsec if required
+	if(ts->tv_nsec >= 1000000000L)
 	{
-		tv->tv_sec++;
-		tv->tv_usec -= 1000000;
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000L;
 	}
 }
 
-
 /**
- * Get time difference in milliseconds
- * @param timeval structure (first)
- * @param timeval structure (second)
- * @return time difference in miliseconds
+ * Subtract time from timespec in milliseconds
+ * @param ts Timespec structure
+ * @param ms Milliseconds to subtract
+ * @return Void
  */
-double timelib_timer_diff(struct timeval tv1, struct timeval tv2)
+void timelib_timespec_sub_ms(struct timespec *ts, unsigned int ms)
 {
-	double time_difference;
-
-	time_difference = (tv2.tv_sec - tv1.tv_sec) * 1000.0;        // sec to ms
-	time_difference += (tv2.tv_usec - tv1.tv_usec) / 1000.0;     // us to ms
-
-	return time_difference;
+	// Decrease time
+	ts->tv_sec -= ms / 1000;
+	ts->tv_nsec -= (long)(ms % 1000) * 1000000L;
+	// Normalize tv_nsec if required
+	if(ts->tv_nsec < 0)
+	{
+		ts->tv_sec--;
+		ts->tv_nsec += 1000000000L;
+	}
 }
 
 /**
- * Get UNIX timestamp in miliseconds
- * @return UNIX timestamp in miliseconds
+ * Add time to timespec in microseconds
+ * @param ts Timespec structure
+ * @param us Microseconds to add (negative to subtract)
+ * @return Void
  */
-double timelib_unix_timestamp()
+void timelib_timespec_add_us(struct timespec *ts, long long us)
 {
-	struct timeval tv_now;
-	double time_now;
-
-	// Get current time
-	gettimeofday(&tv_now, NULL);
-
-	time_now = (double)tv_now.tv_sec * 1000; // sec to ms
-	time_now += (double)tv_now.tv_usec / 1000; // us to ms
-
-	// Check error!!!
-
-	return time_now;
+	// Change time
+	ts->tv_sec += us / 1000000;
+	ts->tv_nsec += (long)(us % 1000000) * 1000L;
+	// Normalize tv_nsec if required
+	if(ts->tv_nsec >= 1000000000L)
+	{
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000L;
+	}
+	else if(ts->tv_nsec < 0)
+	{
+		ts->tv_sec--;
+		ts->tv_nsec += 1000000000L;
+	}
 }
 
+/**
+ * Get timespec difference in microseconds
+ * @param ts1 Timespec structure (first)
+ * @param ts2 Timespec structure (second)
+ * @return time difference in microseconds (negative if second is earlier)
+ */
+long long timelib_timespec_diff_us(struct timespec ts1, struct timespec ts2)
+{
+	return (timelib_timespec_to_ns(&ts2) - timelib_timespec_to_ns(&ts1)) / s_TIMELIB_NS_PER_US;
+}
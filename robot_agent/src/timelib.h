@@ -12,19 +12,138 @@
 #define __TIMELIB_H
 
 /* -- Includes -- */
+/* system libraries */
+#include <time.h>
 
 /* -- Enumurations -- */
 
 /* -- Types -- */
 
+/**
+ * @brief Time or duration in nanoseconds. Monotonic time (timers, releases)
+ * and wall-clock time (protocol time stamps) are kept apart
+ */
+typedef long long timelib_ns_t;
+
 /* -- Constants -- */
+#define s_TIMELIB_CLOCK_REAL			0 // Time of the system clocks, sleeping blocks
+#define s_TIMELIB_CLOCK_VIRTUAL			1 // Simulated time, sleeping advances it at once
+#define s_TIMELIB_VIRTUAL_EPOCH			1577836800 // Wall-clock time when the virtual clock starts (1 Jan 2020, UTC)
+
+#define s_TIMELIB_NS_PER_US				1000LL
+#define s_TIMELIB_NS_PER_MS				1000000LL
+#define s_TIMELIB_NS_PER_S				1000000000LL
+
+/* -- Global Variables -- */
+extern int g_timelib_source; // Clock source (s_TIMELIB_CLOCK_*)
+extern timelib_ns_t g_timelib_virtual_now; // Virtual monotonic time, only moved by sleeping
+
+/* -- Inline Functions -- */
+
+/**
+ * Convert timespec to nanoseconds
+ * @param ts Timespec structure
+ * @return Nanoseconds
+ */
+static inline timelib_ns_t timelib_timespec_to_ns(const struct timespec *ts)
+{
+	return (timelib_ns_t)ts->tv_sec * s_TIMELIB_NS_PER_S + ts->tv_nsec;
+}
+
+/**
+ * Convert nanoseconds to timespec
+ * @param ns Nanoseconds (not negative)
+ * @param ts Timespec structure
+ * @return Void
+ */
+static inline void timelib_ns_to_timespec(timelib_ns_t ns, struct timespec *ts)
+{
+	ts->tv_sec = (time_t)(ns / s_TIMELIB_NS_PER_S);
+	ts->tv_nsec = (long)(ns % s_TIMELIB_NS_PER_S);
+}
+
+/**
+ * Get monotonic time (CLOCK_MONOTONIC, read in the vDSO, or virtual)
+ * @return Nanoseconds
+ */
+static inline timelib_ns_t timelib_now(void)
+{
+	struct timespec ts;
+
+	if(g_timelib_source == s_TIMELIB_CLOCK_VIRTUAL)
+		return g_timelib_virtual_now;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return timelib_timespec_to_ns(&ts);
+}
+
+/**
+ * Get wall-clock time (CLOCK_REALTIME or virtual), for time stamps only:
+ * it can jump, do not measure durations with it
+ * @return Nanoseconds since the epoch
+ */
+static inline timelib_ns_t timelib_wall_now(void)
+{
+	struct timespec ts;
+
+	if(g_timelib_source == s_TIMELIB_CLOCK_VIRTUAL)
+		return (timelib_ns_t)s_TIMELIB_VIRTUAL_EPOCH * s_TIMELIB_NS_PER_S + g_timelib_virtual_now;
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	return timelib_timespec_to_ns(&ts);
+}
+
+/**
+ * Get wall-clock time in milliseconds (protocol time stamps)
+ * @return Milliseconds since the epoch
+ */
+static inline long long timelib_wall_ms(void)
+{
+	return timelib_wall_now() / s_TIMELIB_NS_PER_MS;
+}
+
+/**
+ * Set timer to now
+ * @param timer Timer
+ * @return Void
+ */
+static inline void timelib_timer_set(timelib_ns_t *timer)
+{
+	*timer = timelib_now();
+}
+
+/**
+ * Get elapsed time of a timer
+ * @param timer Timer
+ * @return Elapsed nanoseconds
+ */
+static inline timelib_ns_t timelib_timer_get(timelib_ns_t timer)
+{
+	return timelib_now() - timer;
+}
+
+/**
+ * Get elapsed time of a timer in milliseconds
+ * @param timer Timer
+ * @return Elapsed whole milliseconds
+ */
+static inline long long timelib_timer_get_ms(timelib_ns_t timer)
+{
+	return timelib_timer_get(timer) / s_TIMELIB_NS_PER_MS;
+}
 
 /* -- Function Prototypes -- */
-int timelib_timer_set(struct timeval *tv); // Set timer value
-double timelib_timer_get(struct timeval tv); // Get elapsed time in miliseconds
-double timelib_timer_reset(struct timeval *tv); // Reset timer value
-void timelib_timer_add_ms(struct timeval *tv, unsigned int ms); // Add time to timer in milliseconds
-double timelib_timer_diff(struct timeval tv1, struct timeval tv2); // Get time difference in milliseconds
-double timelib_unix_timestamp(); // Get UNIX timestamp in miliseconds
+void timelib_clock_init(int source); // Select clock source (s_TIMELIB_CLOCK_*)
+int timelib_clock_virtual(void); // Check if the virtual clock is used
+void timelib_clock_gettime(struct timespec *ts); // Get monotonic time as timespec
+time_t timelib_time(void); // Get wall-clock time in seconds
+void timelib_sleep_until(const struct timespec *ts); // Sleep until monotonic time
+void timelib_sleep_us(unsigned int us); // Sleep for microseconds
+timelib_ns_t timelib_timer_reset(timelib_ns_t *timer); // Get elapsed time and restart timer
+long long timelib_timer_advance(timelib_ns_t *timer, timelib_ns_t period); // Count whole periods elapsed and step timer over them
+void timelib_timespec_add_ms(struct timespec *ts, unsigned int ms); // Add time to timespec in milliseconds
+void timelib_timespec_sub_ms(struct timespec *ts, unsigned int ms); // Subtract time from timespec in milliseconds
+void timelib_timespec_add_us(struct timespec *ts, long long us); // Add (or subtract if negative) time to timespec in microseconds
+long long timelib_timespec_diff_us(struct timespec ts1, struct timespec ts2); // Get timespec difference in microseconds
 
 #endif /* __TIMELIB_H */
@@ -0,0 +1,332 @@
+/**
+ * @file	trace.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Event tracer library. Events go into a fixed ring buffer that is allocated
+ * once by trace_init(). Writers claim a slot with an atomic increment and never
+ * lock or allocate, so events can be recorded from tasks, drivers and threads
+ * alike. When the ring is full the oldest events are overwritten. Events are
+ * written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) by a
+ * background job in the slack of the scheduler, and the rest at exit.
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+/* project libraries */
+#include "trace.h"
+#include "config.h"
+#include "scheduler.h"
+#include "timelib.h"
+
+/* -- Defines -- */
+#define s_TRACE_FLUSH_CHUNK		32 // Events written between two checks of the remaining slack
+
+/* -- Global Variables -- */
+static trace_event_t *trace_ring = NULL; // Ring buffer
+static uint64_t trace_mask = 0; // Ring size - 1 (size is a power of two)
+static uint64_t trace_head = 0; // Sequence number of the next event
+static __thread int32_t trace_tid = 0; // Cached thread ID of the caller
+static int trace_depths[s_TRACE_QUEUE_NUM]; // Last recorded queue depths
+static FILE *trace_fp = NULL; // Trace file, open from the first flush until the final dump
+static uint64_t trace_flushed = 0; // Sequence number of the next event to write
+static uint64_t trace_dropped = 0; // Events overwritten before they were written
+static uint64_t trace_t0 = 0; // Time stamp of the first written event
+static int trace_written = 0; // Events written
+
+// Queue names, indexed by queue ID
+static const char *trace_queue_names[s_TRACE_QUEUE_NUM] =
+{
+	"queue mission", "queue navigate", "send robot", "send victim", "send pheromones", "send stream"
+};
+
+/* -- Functions -- */
+
+/**
+ * Write ring buffer at exit (also reached through exit() in signal handlers)
+ * @return Void
+ */
+static void trace_exit(void)
+{
+	if(trace_ring != NULL)
+		trace_dump(g_config.trace_path);
+	trace_destroy();
+}
+
+/**
+ * Allocate ring buffer
+ * @param events Ring size in events (rounded up to a power of two), 0 disables tracing
+ * @return s_OK if successful, s_ERROR if failed
+ */
+int trace_init(int events)
+{
+	uint64_t size = 1;
+	int i;
+
+	if(events <= 0)
+		return s_OK;
+
+	while(size < (uint64_t)events)
+		size <<= 1;
+
+	trace_ring = (trace_event_t *)calloc(size, sizeof(trace_event_t));
+	if(trace_ring == NULL) {
+		printf("trace_init: could not allocate %llu events.\n", (unsigned long long)size);
+		return s_ERROR;
+	}
+	for(i = 0; i < s_TRACE_QUEUE_NUM; i++)
+		trace_depths[i] = -1;
+	trace_head = 0;
+	trace_mask = size - 1;
+
+	atexit(trace_exit);
+	// Write the ring out in the slack of the scheduler
+	scheduler_add_job(trace_flush, "trace flush");
+
+	return s_OK;
+}
+
+/**
+ * Free ring buffer
+ * @return Void
+ */
+void trace_destroy(void)
+{
+	trace_mask = 0;
+	free(trace_ring);
+	trace_ring = NULL;
+}
+
+/**
+ * Record event
+ * @param type Event type (s_TRACE_EVENT_*)
+ * @param id Task ID, sensor packet ID or queue ID
+ * @param arg Bytes, result or queue depth
+ * @return Void
+ */
+void trace_event(int type, int id, int arg)
+{
+	timelib_ns_t ts;
+	trace_event_t *ev;
+	uint64_t seq;
+
+	if(trace_mask == 0)
+		return;
+	if(trace_tid == 0)
+		trace_tid = (int32_t)syscall(SYS_gettid);
+
+	ts = timelib_now();
+
+	// Claim a slot, mark it as being written, fill it and publish it
+	seq = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+	ev = &trace_ring[seq & trace_mask];
+	__atomic_store_n(&ev->seq, 0, __ATOMIC_RELAXED);
+	// The payload stores must not move above the mark (seqlock, as in slot.c)
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	ev->ts = (uint64_t)ts;
+	ev->type = (uint16_t)type;
+	ev->id = (uint16_t)id;
+	ev->arg = (int32_t)arg;
+	ev->tid = trace_tid;
+	__atomic_store_n(&ev->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Record queue depth if it changed since the last sample
+ * @param queue_id Queue ID (s_TRACE_QUEUE_*)
+ * @param depth Number of items in the queue
+ * @return Void
+ */
+void trace_queue_depth(int queue_id, int depth)
+{
+	if(trace_mask == 0 || trace_depths[queue_id] == depth)
+		return;
+	trace_depths[queue_id] = depth;
+	trace_event(s_TRACE_EVENT_QUEUE_DEPTH, queue_id, depth);
+}
+
+/**
+ * Open trace file and write the JSON header
+ * @param path Output file path
+ * @return s_OK if successful, s_ERROR if failed
+ */
+static int trace_open(const char *path)
+{
+	int pid = g_config.robot_id;
+
+	trace_fp = fopen(path, "w");
+	if(trace_fp == NULL) {
+		printf("trace: could not open %s.\n", path);
+		return s_ERROR;
+	}
+	fprintf(trace_fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(trace_fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"robot %d\"}}", pid, pid);
+
+	return s_OK;
+}
+
+/**
+ * Write one event as Chrome trace JSON
+ * @param ev Pointer to event
+ * @return Void
+ */
+static void trace_write_event(const trace_event_t *ev)
+{
+	FILE *fp = trace_fp;
+	int pid = g_config.robot_id;
+	double ts;
+
+	if(trace_t0 == 0)
+		trace_t0 = ev->ts;
+	ts = (double)(ev->ts - trace_t0) / 1e3;
+
+	fprintf(fp, ",\n");
+	switch(ev->type) {
+		case s_TRACE_EVENT_TASK_BEGIN :
+		case s_TRACE_EVENT_TASK_END :
+			fprintf(fp, "{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+				scheduler_get_task_name(ev->id), ev->type == s_TRACE_EVENT_TASK_BEGIN ? "B" : "E", ts, pid, ev->tid);
+			break;
+		case s_TRACE_EVENT_SERIAL_REQ :
+			fprintf(fp, "{\"name\":\"OI sensor %d\",\"cat\":\"serial\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"expected\":%d}}",
+				ev->id, ts, pid, ev->tid, ev->arg);
+			break;
+		case s_TRACE_EVENT_SERIAL_RESP :
+			fprintf(fp, "{\"name\":\"OI sensor %d\",\"cat\":\"serial\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"received\":%d}}",
+				ev->id, ts, pid, ev->tid, ev->arg);
+			break;
+		case s_TRACE_EVENT_RFID_BEGIN :
+			fprintf(fp, "{\"name\":\"RFID read\",\"cat\":\"serial\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+				ts, pid, ev->tid);
+			break;
+		case s_TRACE_EVENT_RFID_END :
+			fprintf(fp, "{\"name\":\"RFID read\",\"cat\":\"serial\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"tag\":%s}}",
+				ts, pid, ev->tid, ev->arg == 0 ? "true" : "false");
+			break;
+		case s_TRACE_EVENT_UDP_SEND :
+		case s_TRACE_EVENT_UDP_RECV :
+			fprintf(fp, "{\"name\":\"UDP %s\",\"cat\":\"udp\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"bytes\":%d}}",
+				ev->type == s_TRACE_EVENT_UDP_SEND ? "send" : "recv", ts, pid, ev->tid, ev->arg);
+			break;
+		case s_TRACE_EVENT_QUEUE_DEPTH :
+			fprintf(fp, "{\"name\":\"%s\",\"cat\":\"queue\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"args\":{\"depth\":%d}}",
+				ev->id < s_TRACE_QUEUE_NUM ? trace_queue_names[ev->id] : "queue", ts, pid, ev->arg);
+			break;
+		case s_TRACE_EVENT_EXTRACT_BEGIN :
+			fprintf(fp, "{\"name\":\"pheromone extract\",\"cat\":\"pheromone\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+				ts, pid, ev->tid);
+			break;
+		case s_TRACE_EVENT_EXTRACT_END :
+			fprintf(fp, "{\"name\":\"pheromone extract\",\"cat\":\"pheromone\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"sectors\":%d}}",
+				ts, pid, ev->tid, ev->arg);
+			break;
+		case s_TRACE_EVENT_MODE_CHANGE :
+			fprintf(fp, "{\"name\":\"mode %s\",\"cat\":\"scheduler\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"task\":\"%s\"}}",
+				ev->id == s_SCHEDULER_MODE_DEGRADED ? "degraded" : "normal", ts, pid, ev->tid, scheduler_get_task_name(ev->arg));
+			break;
+		case s_TRACE_EVENT_BUDGET :
+			fprintf(fp, "{\"name\":\"%s over budget\",\"cat\":\"scheduler\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"budget_ms\":%d}}",
+				scheduler_get_task_name(ev->id), ts, pid, ev->tid, ev->arg);
+			break;
+		default :
+			fprintf(fp, "{\"name\":\"event %d\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"id\":%d,\"arg\":%d}}",
+				ev->type, ts, pid, ev->tid, ev->id, ev->arg);
+			break;
+	}
+	trace_written++;
+}
+
+/**
+ * Write recorded events that are not written yet
+ * @param final s_TRUE at exit: skip events still being written instead of waiting for them
+ * @return s_TRUE if events are left to write, s_FALSE otherwise
+ */
+static int trace_write_pending(int final)
+{
+	trace_event_t ev, *slot;
+	uint64_t head, seq, first;
+	int n = 0;
+
+	head = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE);
+	first = (head > trace_mask + 1) ? head - (trace_mask + 1) : 0;
+
+	// Events overwritten before they could be written are lost
+	if(trace_flushed < first) {
+		trace_dropped += first - trace_flushed;
+		trace_flushed = first;
+	}
+
+	while(trace_flushed < head) {
+		// Between chunks, stop when the slack of the scheduler is used up
+		if(final == s_FALSE && (n % s_TRACE_FLUSH_CHUNK) == 0 && n > 0
+			&& scheduler_slack_remaining_us() == 0)
+			return s_TRUE;
+
+		// Copy the slot and check that it was not (re)written meanwhile
+		seq = trace_flushed;
+		slot = &trace_ring[seq & trace_mask];
+		if(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == seq + 1) {
+			ev = *slot;
+			// The second check must not move above the copy
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq + 1) {
+				trace_write_event(&ev);
+				trace_flushed++;
+				n++;
+				continue;
+			}
+		}
+		// The event is still being written (retry later) or was overwritten
+		if(final == s_FALSE && seq >= first)
+			return s_FALSE;
+		trace_dropped++;
+		trace_flushed++;
+	}
+
+	return s_FALSE;
+}
+
+/**
+ * Background job: write pending events to the trace file in the slack of the
+ * scheduler, so the ring does not overflow on long runs
+ * @return s_TRUE if events are left to write, s_FALSE otherwise
+ */
+int trace_flush(void)
+{
+	if(trace_ring == NULL)
+		return s_FALSE;
+	if(trace_fp == NULL && trace_open(g_config.trace_path) == s_ERROR)
+		return s_FALSE;
+
+	return trace_write_pending(s_FALSE);
+}
+
+/**
+ * Write all remaining events and close the Chrome trace JSON file
+ * @param path Output file path (used if nothing was flushed to a file yet)
+ * @return s_OK if successful, s_ERROR if failed
+ */
+int trace_dump(const char *path)
+{
+	if(trace_ring == NULL)
+		return s_ERROR;
+	if(trace_fp == NULL && trace_open(path) == s_ERROR)
+		return s_ERROR;
+
+	trace_write_pending(s_TRUE);
+
+	fprintf(trace_fp, "\n]}\n");
+	fclose(trace_fp);
+	trace_fp = NULL;
+
+	printf("Trace: %d events written to %s (%llu dropped)\n", trace_written, path, (unsigned long long)trace_dropped);
+
+	return s_OK;
+}
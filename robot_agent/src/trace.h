@@ -0,0 +1,69 @@
+/**
+ * @file	trace.h
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Event tracer library header file.
+ */
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdint.h>
+/* project libraries */
+#include "def.h"
+
+/* -- Types -- */
+
+/**
+ * @brief Trace event structure (one slot of the ring buffer)
+ */
+typedef struct s_TRACE_EVENT_STRUCT
+{
+	uint64_t seq; // Sequence number + 1 of the event held by the slot, 0 while it is written
+	uint64_t ts; // Time stamp (ns, CLOCK_MONOTONIC)
+	uint16_t type; // Event type (s_TRACE_EVENT_*)
+	uint16_t id; // Task ID, sensor packet ID or queue ID
+	int32_t arg; // Bytes, result or queue depth
+	int32_t tid; // Thread ID
+
+} trace_event_t;
+
+/* -- Constants -- */
+/* Event types */
+#define s_TRACE_EVENT_TASK_BEGIN			1 // Task starts (id: task ID)
+#define s_TRACE_EVENT_TASK_END				2 // Task ends (id: task ID)
+#define s_TRACE_EVENT_SERIAL_REQ			3 // OI sensor request written (id: packet ID, arg: bytes expected)
+#define s_TRACE_EVENT_SERIAL_RESP			4 // OI sensor response read (id: packet ID, arg: bytes received)
+#define s_TRACE_EVENT_RFID_BEGIN			5 // RFID read starts
+#define s_TRACE_EVENT_RFID_END				6 // RFID read ends (arg: 0 if a tag was read, -1 otherwise)
+#define s_TRACE_EVENT_UDP_SEND				7 // UDP packet broadcast (arg: bytes, -1 if failed)
+#define s_TRACE_EVENT_UDP_RECV				8 // UDP packet received (arg: bytes)
+#define s_TRACE_EVENT_QUEUE_DEPTH			9 // Queue depth changed (id: s_TRACE_QUEUE_*, arg: depth)
+#define s_TRACE_EVENT_EXTRACT_BEGIN			10 // Pheromone map extraction starts
+#define s_TRACE_EVENT_EXTRACT_END			11 // Pheromone map extraction ends (arg: sectors)
+#define s_TRACE_EVENT_MODE_CHANGE			12 // Overload mode switch (id: new mode, arg: task ID that caused it)
+#define s_TRACE_EVENT_BUDGET				13 // Job exceeded its budget (id: task ID, arg: budget in ms)
+
+/* Queue IDs */
+#define s_TRACE_QUEUE_MISSION				0
+#define s_TRACE_QUEUE_NAVIGATE				1
+#define s_TRACE_QUEUE_SEND_ROBOT			2
+#define s_TRACE_QUEUE_SEND_VICTIM			3
+#define s_TRACE_QUEUE_SEND_PHEROMONES		4
+#define s_TRACE_QUEUE_SEND_STREAM			5
+#define s_TRACE_QUEUE_NUM					6
+
+/* -- Function Prototypes -- */
+int trace_init(int events); // Allocate ring buffer, 0 disables tracing
+void trace_destroy(void); // Free ring buffer
+void trace_event(int type, int id, int arg); // Record event (lock-free, no allocation)
+void trace_queue_depth(int queue_id, int depth); // Record queue depth if it changed
+int trace_flush(void); // Background job: write pending events within the scheduler slack
+int trace_dump(const char *path); // Write remaining events and close the Chrome trace JSON
+
+#endif /* __TRACE_H */
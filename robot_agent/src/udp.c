@@ -22,6 +22,7 @@
 #include "udp.h"
 #include "config.h"
 #include "def.h"
+#include "trace.h"
 
  /* -- Defines -- */
 
@@ -162,8 +163,10 @@ int udp_broadcast(udp_t *udp, char *packet, int len)
 	// Broadcast UDP packet/datagram
 	if(sendto(udp->sd_send, packet, len, 0, (struct sockaddr *)&udp->sock_send, sizeof(udp->sock_send)) == s_ERROR) {
 		printf("udp_broadcast: could not send UDP packet.\n");
+		trace_event(s_TRACE_EVENT_UDP_SEND, 0, -1);
 		return s_ERROR;
 	}
+	trace_event(s_TRACE_EVENT_UDP_SEND, 0, len);
 
 	return s_OK;
 }
@@ -206,6 +209,7 @@ int udp_receive(udp_t *udp, char *packet, int *len)
 
         // End string
         packet[*len] = '\0';
+        trace_event(s_TRACE_EVENT_UDP_RECV, 0, *len);
 
         // Print received packet content and information
 		/*printf("recv from %s:%d - data: %s\n",
@@ -218,3 +222,30 @@ int udp_receive(udp_t *udp, char *packet, int *len)
 
 	return s_ERROR;
 }
+
+/**
+ * Receive packet if one is waiting, without select() or blocking
+ * @param udp Pointer to UDP structure
+ * @param packet Buffer of packet_size + 1 bytes for the packet
+ * @param len Pointer to the length of the received packet
+ * @return s_OK if a packet was received, s_ERROR otherwise
+ */
+int udp_poll(udp_t *udp, char *packet, int *len)
+{
+	// Receive packet/datagram
+	if((*len = recvfrom(	udp->sd_recv,
+							packet,
+							udp->packet_size,
+							MSG_DONTWAIT,
+							(struct sockaddr *)&udp->sock_conn,
+							&udp->sock_conn_len)) < 0)
+	{
+		return s_ERROR;
+	}
+
+	// End string
+	packet[*len] = '\0';
+	trace_event(s_TRACE_EVENT_UDP_RECV, 0, *len);
+
+	return s_OK;
+}
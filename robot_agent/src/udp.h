@@ -57,6 +57,7 @@ udp_t *udp_open(char *broadcast_ip, int port, int packet_size); // Open UDP broa
 int udp_close(udp_t *udp); // Deinitialize UDP
 int udp_broadcast(udp_t *udp, char *packet, int len); // Broadcast packet through UDP
 int udp_receive(udp_t *udp, char *packet, int *len); // Receive packet through UDP
+int udp_poll(udp_t *udp, char *packet, int *len); // Receive packet if one is waiting (never blocks)
  
 
 
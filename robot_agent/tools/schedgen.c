@@ -0,0 +1,512 @@
+/**
+ * @file	schedgen.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Offline cyclic schedule generator. Reads the task table of config.ini
+ * (periods, phases, deadlines and WCETs, optionally overridden by measured
+ * WCETs), picks the largest legal minor frame, splits tasks that do not fit
+ * in one frame into slices, packs all jobs of a major cycle into frames and
+ * writes the frame table that scheduler.c compiles in when
+ * s_CONFIG_SCHEDULE_TABLE_ENABLE is defined.
+ *
+ * Usage: schedgen [-c config.ini] [-r robot_id] [-w task=ms ...] [-o schedule_table.h]
+ */
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+/* project libraries */
+#include "config.h"
+#include "def.h"
+
+/* -- Defines -- */
+// Upper limit of minor frames in a major cycle (same as the scheduler)
+#define SCHEDGEN_MAX_FRAMES		1000
+// Upper limit of jobs in a major cycle
+#define SCHEDGEN_MAX_JOBS		4096
+
+/* -- Types -- */
+
+/**
+ * @brief Frame table entry
+ */
+typedef struct s_SCHEDGEN_ENTRY_STRUCT
+{
+	int task_id; // Task ID
+	int slice; // Slice index, 0 dispatches the task, >0 reserves budget for its spill-over
+	int lag; // Frame start minus release of the job (ms)
+	int budget; // Budget of the slice (ms)
+
+} schedgen_entry_t;
+
+/**
+ * @brief Minor frame under construction
+ */
+typedef struct s_SCHEDGEN_FRAME_STRUCT
+{
+	int entry_num; // Number of entries
+	schedgen_entry_t entries[s_CONFIG_TASK_NUM]; // Entries in dispatch order
+	int load; // Sum of budgets (ms)
+	int head; // Frame starts with the spill-over of a split task
+	int tail; // Frame ends with the first slice of a split task
+
+} schedgen_frame_t;
+
+/**
+ * @brief Job (one release of a task in the major cycle)
+ */
+typedef struct s_SCHEDGEN_JOB_STRUCT
+{
+	int task_id; // Task ID
+	int release; // Release (ms from major cycle start)
+	int deadline; // Absolute deadline (ms from major cycle start)
+
+} schedgen_job_t;
+
+/* -- Global Variables -- */
+// Task names as used in config.ini sections ("task_<name>"), indexed by task ID
+static const char *schedgen_names[s_CONFIG_TASK_NUM + 1] =
+{
+	"nop", "mission", "navigate", "control", "refine", "report", "communicate", "avoid"
+};
+
+// Task ID macros (task.h), indexed by task ID
+static const char *schedgen_ids[s_CONFIG_TASK_NUM + 1] =
+{
+	"s_TASK_NOP_ID", "s_TASK_MISSION_ID", "s_TASK_NAVIGATE_ID", "s_TASK_CONTROL_ID",
+	"s_TASK_REFINE_ID", "s_TASK_REPORT_ID", "s_TASK_COMMUNICATE_ID", "s_TASK_AVOID_ID"
+};
+
+// Rank of each task in the dispatch order of the scheduler, indexed by task ID
+static const int schedgen_rank[s_CONFIG_TASK_NUM + 1] =
+{
+	0, 7, 2, 3, 5, 6, 1, 4
+};
+
+static schedgen_job_t schedgen_jobs[SCHEDGEN_MAX_JOBS];
+static schedgen_frame_t schedgen_frames[SCHEDGEN_MAX_FRAMES];
+// Absolute index of the last frame used by each task, and of its first job
+static int schedgen_last[s_CONFIG_TASK_NUM + 1];
+static int schedgen_first[s_CONFIG_TASK_NUM + 1];
+
+/* -- Functions -- */
+
+/**
+ * Greatest common divisor
+ */
+static int schedgen_gcd(int a, int b)
+{
+	int t;
+	while (b != 0) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/**
+ * Compare jobs by deadline, then by release (qsort callback)
+ */
+static int schedgen_job_cmp(const void *a, const void *b)
+{
+	const schedgen_job_t *ja = (const schedgen_job_t *)a;
+	const schedgen_job_t *jb = (const schedgen_job_t *)b;
+
+	if (ja->deadline != jb->deadline)
+		return ja->deadline - jb->deadline;
+	if (ja->release != jb->release)
+		return ja->release - jb->release;
+	return ja->task_id - jb->task_id;
+}
+
+/**
+ * Check if a frame already holds an entry of a task
+ */
+static int schedgen_frame_has(schedgen_frame_t *frame, int task_id)
+{
+	int i;
+	for (i = 0; i < frame->entry_num; i++) {
+		if (frame->entries[i].task_id == task_id)
+			return s_TRUE;
+	}
+	return s_FALSE;
+}
+
+/**
+ * Add an entry to a frame
+ * @param frame Frame
+ * @param front s_TRUE to insert in front of the other entries
+ */
+static void schedgen_frame_add(schedgen_frame_t *frame, int front, int task_id, int slice, int lag, int budget)
+{
+	schedgen_entry_t entry = { task_id, slice, lag, budget };
+
+	if (front) {
+		memmove(&frame->entries[1], &frame->entries[0], frame->entry_num * sizeof(schedgen_entry_t));
+		frame->entries[0] = entry;
+	}
+	else {
+		frame->entries[frame->entry_num] = entry;
+	}
+	frame->entry_num++;
+	frame->load += budget;
+}
+
+/**
+ * Place one job in the frames, earliest fitting frame first
+ * @param job Job
+ * @param f Frame size (ms)
+ * @param n Number of frames
+ * @return s_OK if the job was placed, s_ERROR otherwise
+ */
+static int schedgen_place(schedgen_job_t *job, int f, int n)
+{
+	int first, last, j, k, rest, avail, budget, slice;
+	int wcet = g_config.tasks[job->task_id].wcet;
+	schedgen_frame_t *frame;
+
+	// Frames that lie completely inside the job window, after the previous job of the task
+	first = (job->release + f - 1) / f;
+	last = job->deadline / f - 1;
+	if (first <= schedgen_last[job->task_id])
+		first = schedgen_last[job->task_id] + 1;
+
+	for (j = first; j <= last; j++) {
+		frame = &schedgen_frames[j % n];
+		if (frame->tail || schedgen_frame_has(frame, job->task_id))
+			continue;
+		avail = f - frame->load;
+
+		// Job fits in this frame
+		if (wcet <= avail) {
+			schedgen_frame_add(frame, s_FALSE, job->task_id, 0, j * f - job->release, wcet);
+			schedgen_last[job->task_id] = j;
+			return s_OK;
+		}
+		// Job fits in no frame, so it is split: the first slice closes this frame and
+		// the rest spills over into the start of the following frames
+		if (wcet <= f || avail <= 0)
+			continue;
+		rest = wcet - avail;
+		for (k = j + 1; rest > 0 && k <= last && k - j < n; k++) {
+			frame = &schedgen_frames[k % n];
+			budget = rest < f ? rest : f;
+			if (frame->head || frame->tail || schedgen_frame_has(frame, job->task_id) || frame->load + budget > f)
+				break;
+			rest -= budget;
+		}
+		if (rest > 0)
+			continue;
+
+		// Commit the slices
+		schedgen_frame_add(&schedgen_frames[j % n], s_FALSE, job->task_id, 0, j * f - job->release, avail);
+		schedgen_frames[j % n].tail = s_TRUE;
+		rest = wcet - avail;
+		for (k = j + 1, slice = 1; rest > 0; k++, slice++) {
+			frame = &schedgen_frames[k % n];
+			budget = rest < f ? rest : f;
+			schedgen_frame_add(frame, s_TRUE, job->task_id, slice, k * f - job->release, budget);
+			frame->head = s_TRUE;
+			if (budget == f)
+				frame->tail = s_TRUE;
+			rest -= budget;
+		}
+		schedgen_last[job->task_id] = k - 1;
+		return s_OK;
+	}
+
+	return s_ERROR;
+}
+
+/**
+ * Pack all jobs of a major cycle into frames of size f
+ * @param job_num Number of jobs (sorted by deadline)
+ * @param f Frame size (ms)
+ * @param n Number of frames
+ * @return s_OK if all jobs fit, s_ERROR otherwise
+ */
+static int schedgen_pack(int job_num, int f, int n)
+{
+	int i, task_id;
+
+	memset(schedgen_frames, 0, sizeof(schedgen_frames));
+	for (task_id = 0; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		schedgen_last[task_id] = -1;
+		schedgen_first[task_id] = -1;
+	}
+
+	for (i = 0; i < job_num; i++) {
+		task_id = schedgen_jobs[i].task_id;
+		if (schedgen_place(&schedgen_jobs[i], f, n) == s_ERROR) {
+			fprintf(stderr, "  f = %d ms: no frame for %s released at %d ms (deadline %d ms)\n",
+				f, schedgen_names[task_id], schedgen_jobs[i].release, schedgen_jobs[i].deadline);
+			return s_ERROR;
+		}
+		if (schedgen_first[task_id] < 0)
+			schedgen_first[task_id] = (schedgen_jobs[i].release + f - 1) / f;
+	}
+
+	// Jobs that wrap around must stay ahead of the first job of the next major cycle
+	for (task_id = 1; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		if (schedgen_last[task_id] >= 0 && schedgen_last[task_id] >= n + schedgen_first[task_id]) {
+			fprintf(stderr, "  f = %d ms: %s overlaps its next major cycle\n", f, schedgen_names[task_id]);
+			return s_ERROR;
+		}
+	}
+
+	return s_OK;
+}
+
+/**
+ * Order the entries of a frame like the scheduler does (data flows from
+ * communicate and navigate to control), keeping a spill-over slice first and
+ * the first slice of a split task last
+ */
+static void schedgen_order_frame(schedgen_frame_t *frame)
+{
+	int i, j, begin, end;
+	schedgen_entry_t entry;
+
+	begin = frame->head ? 1 : 0;
+	end = frame->entry_num;
+	if (end > begin && frame->entries[end - 1].slice == 0 && frame->tail)
+		end--;
+
+	// Insertion sort, a frame holds at most one entry per task
+	for (i = begin + 1; i < end; i++) {
+		entry = frame->entries[i];
+		for (j = i; j > begin && schedgen_rank[frame->entries[j - 1].task_id] > schedgen_rank[entry.task_id]; j--)
+			frame->entries[j] = frame->entries[j - 1];
+		frame->entries[j] = entry;
+	}
+}
+
+/**
+ * Check the frame size constraints for frame size f
+ * @return s_OK if f is legal, s_ERROR otherwise
+ */
+static int schedgen_check_frame(int f, int major, const int *phases)
+{
+	int task_id;
+	config_task_t *task;
+
+	// The frame must divide the major cycle
+	if (major % f != 0 || major / f > SCHEDGEN_MAX_FRAMES)
+		return s_ERROR;
+
+	for (task_id = 1; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		task = &g_config.tasks[task_id];
+		if (task->period <= 0)
+			continue;
+		// At least one frame between release and deadline of every job
+		if (2 * f - schedgen_gcd(f, task->period) > task->deadline)
+			return s_ERROR;
+		// At most one job of a task per frame
+		if (f > task->period)
+			return s_ERROR;
+		// Releases fall on frame boundaries
+		if (phases[task_id] % f != 0)
+			return s_ERROR;
+	}
+
+	return s_OK;
+}
+
+/**
+ * Write the frame table as a C header
+ */
+static void schedgen_write(FILE *out, const char *config_path, int tdma, int f, int major)
+{
+	int i, j, n, entry_num = 0;
+	schedgen_entry_t *entry;
+
+	n = major / f;
+	for (i = 0; i < n; i++)
+		entry_num += schedgen_frames[i].entry_num;
+
+	fprintf(out, "/**\n");
+	fprintf(out, " * @file\tschedule_table.h\n");
+	fprintf(out, " *\n");
+	fprintf(out, " * @section DESCRIPTION\n");
+	fprintf(out, " *\n");
+	fprintf(out, " * Cyclic schedule generated by schedgen from %s, do not edit.\n", config_path);
+	fprintf(out, " * Regenerate with \"make schedule\" after changing the task table.\n");
+	fprintf(out, " */\n\n");
+	fprintf(out, "#ifndef __SCHEDULE_TABLE_H\n");
+	fprintf(out, "#define __SCHEDULE_TABLE_H\n\n");
+	fprintf(out, "// Robot the TDMA slots were placed for (-1 if the table has no TDMA task)\n");
+	fprintf(out, "#define s_SCHEDULE_TABLE_ROBOT_ID\t\t%d\n", tdma ? g_config.robot_id : -1);
+	fprintf(out, "#define s_SCHEDULE_TABLE_MINOR\t\t\t%d\n", f);
+	fprintf(out, "#define s_SCHEDULE_TABLE_MAJOR\t\t\t%d\n", major);
+	fprintf(out, "#define s_SCHEDULE_TABLE_ENTRY_NUM\t\t%d\n\n", entry_num);
+	fprintf(out, "// { frame, task ID, slice, lag (ms), budget (ms) }\n");
+	fprintf(out, "static const scheduler_table_entry_t schedule_table[s_SCHEDULE_TABLE_ENTRY_NUM] =\n{\n");
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < schedgen_frames[i].entry_num; j++) {
+			entry = &schedgen_frames[i].entries[j];
+			entry_num--;
+			fprintf(out, "\t{ %d, %s, %d, %d, %d }%s\n", i, schedgen_ids[entry->task_id],
+				entry->slice, entry->lag, entry->budget, entry_num > 0 ? "," : "");
+		}
+	}
+	fprintf(out, "};\n\n");
+	fprintf(out, "#endif /* __SCHEDULE_TABLE_H */\n");
+}
+
+/**
+ * Print usage
+ */
+static void schedgen_usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-c config.ini] [-r robot_id] [-w task=ms ...] [-o schedule_table.h]\n", name);
+	fprintf(stderr, "  -c  configuration file with the task table (default ./res/config.ini)\n");
+	fprintf(stderr, "  -r  robot ID used to place the TDMA slot (default robot:id)\n");
+	fprintf(stderr, "  -w  override a WCET with a measured one, e.g. -w navigate=23.4\n");
+	fprintf(stderr, "  -o  output file (default stdout)\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *config_path = "./res/config.ini";
+	const char *out_path = NULL;
+	const char *wcet_args[s_CONFIG_TASK_NUM * 2];
+	int wcet_num = 0, robot_id = -1;
+	int opt, i, k, task_id, f, n, job_num, major, tdma = s_FALSE;
+	int phases[s_CONFIG_TASK_NUM + 1] = {0};
+	config_task_t *task;
+	const char *value;
+	double util = 0;
+	FILE *out;
+
+	while ((opt = getopt(argc, argv, "c:r:w:o:h")) != -1) {
+		switch (opt) {
+			case 'c': config_path = optarg; break;
+			case 'r': robot_id = atoi(optarg); break;
+			case 'o': out_path = optarg; break;
+			case 'w':
+				if (wcet_num < s_CONFIG_TASK_NUM * 2)
+					wcet_args[wcet_num++] = optarg;
+				break;
+			default:
+				schedgen_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	config_load_file(config_path);
+	if (robot_id >= 0)
+		g_config.robot_id = robot_id;
+
+	// Measured WCETs (rounded up to whole milliseconds)
+	for (i = 0; i < wcet_num; i++) {
+		value = strchr(wcet_args[i], '=');
+		for (task_id = 1; value != NULL && task_id <= s_CONFIG_TASK_NUM; task_id++) {
+			if (strncmp(wcet_args[i], schedgen_names[task_id], value - wcet_args[i]) == 0
+				&& (int)strlen(schedgen_names[task_id]) == value - wcet_args[i])
+				break;
+		}
+		if (value == NULL || task_id > s_CONFIG_TASK_NUM) {
+			fprintf(stderr, "schedgen: bad WCET override '%s'\n", wcet_args[i]);
+			return 1;
+		}
+		g_config.tasks[task_id].wcet = (int)ceil(atof(value + 1));
+	}
+
+	// Major cycle, resolved phases and utilization
+	major = 1;
+	for (task_id = 1; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		task = &g_config.tasks[task_id];
+		if (task->period <= 0)
+			continue;
+		phases[task_id] = task->phase;
+		if (task->phase == s_CONFIG_TASK_PHASE_TDMA) {
+			// One configured minor cycle per robot ID, the job must run inside its slot
+			phases[task_id] = g_config.robot_id * g_config.scheduler_minor_cycle;
+			if (task->deadline > g_config.scheduler_minor_cycle)
+				task->deadline = g_config.scheduler_minor_cycle;
+			tdma = s_TRUE;
+		}
+		if (phases[task_id] < 0 || phases[task_id] >= task->period || task->wcet > task->deadline) {
+			fprintf(stderr, "schedgen: %s has phase %d ms, WCET %d ms and deadline %d ms in a %d ms period\n",
+				schedgen_names[task_id], phases[task_id], task->wcet, task->deadline, task->period);
+			return 1;
+		}
+		major = major / schedgen_gcd(major, task->period) * task->period;
+		util += (double)task->wcet / task->period;
+	}
+	fprintf(stderr, "schedgen: major cycle %d ms, utilization %.2f\n", major, util);
+	if (util > 1.0) {
+		fprintf(stderr, "schedgen: task table overloads the processor\n");
+		return 1;
+	}
+
+	// Jobs of one major cycle, in deadline order
+	job_num = 0;
+	for (task_id = 1; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		task = &g_config.tasks[task_id];
+		if (task->period <= 0)
+			continue;
+		for (k = 0; k < major / task->period; k++) {
+			if (job_num == SCHEDGEN_MAX_JOBS) {
+				fprintf(stderr, "schedgen: more than %d jobs in a major cycle\n", SCHEDGEN_MAX_JOBS);
+				return 1;
+			}
+			schedgen_jobs[job_num].task_id = task_id;
+			schedgen_jobs[job_num].release = phases[task_id] + k * task->period;
+			schedgen_jobs[job_num].deadline = schedgen_jobs[job_num].release + task->deadline;
+			job_num++;
+		}
+	}
+	qsort(schedgen_jobs, job_num, sizeof(schedgen_job_t), schedgen_job_cmp);
+
+	// Largest legal frame that all jobs can be packed into
+	for (f = major; f > 0; f--) {
+		if (schedgen_check_frame(f, major, phases) == s_ERROR)
+			continue;
+		n = major / f;
+		if (schedgen_pack(job_num, f, n) == s_OK)
+			break;
+	}
+	if (f == 0) {
+		fprintf(stderr, "schedgen: no feasible frame size\n");
+		return 1;
+	}
+
+	// Show the result
+	for (i = 0; i < n; i++)
+		schedgen_order_frame(&schedgen_frames[i]);
+	fprintf(stderr, "schedgen: minor cycle %d ms, %d frames\n", f, n);
+	for (i = 0; i < n; i++) {
+		fprintf(stderr, "  Frame %d (%d ms):", i, schedgen_frames[i].load);
+		for (k = 0; k < schedgen_frames[i].entry_num; k++) {
+			if (schedgen_frames[i].entries[k].slice > 0)
+				fprintf(stderr, " %s#%d", schedgen_names[schedgen_frames[i].entries[k].task_id], schedgen_frames[i].entries[k].slice);
+			else
+				fprintf(stderr, " %s", schedgen_names[schedgen_frames[i].entries[k].task_id]);
+		}
+		fprintf(stderr, "\n");
+	}
+
+	// Write the table
+	out = stdout;
+	if (out_path != NULL) {
+		out = fopen(out_path, "w");
+		if (out == NULL) {
+			perror(out_path);
+			return 1;
+		}
+	}
+	schedgen_write(out, config_path, tdma, f, major);
+	if (out != stdout)
+		fclose(out);
+
+	return 0;
+}
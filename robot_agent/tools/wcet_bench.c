@@ -0,0 +1,634 @@
+/**
+ * @file	wcet_bench.c
+ * @author  LabGroupA5
+ * @date	16 Oct 2026
+ *
+ * @section DESCRIPTION
+ *
+ * Offline WCET measurement harness. Links the task bodies of the robot
+ * agent, serves the Open Interface and the RFID reader from pseudo
+ * terminals and feeds UDP packets (robot poses, victims, pheromone map
+ * sectors, GO_AHEAD) to the agent's own socket. Every task is run many
+ * times back-to-back (warm caches) and after evicting the caches (cold),
+ * and the execution time distribution of every task is printed together
+ * with the budgets of config.ini and the schedgen WCET overrides to use.
+ *
+ * Inputs are synthetic unless recordings are given: a raw byte stream of
+ * Open Interface sensor replies, RFID tag IDs (one per line, an empty line
+ * for no tag) and UDP packets (one per line).
+ *
+ * Usage: wcet_bench [-c config.ini] [-n runs] [-t task] [-m margin] [-s oi.bin] [-r tags.txt] [-u packets.txt]
+ */
+
+#define _GNU_SOURCE // ptsname_r()
+
+/* -- Includes -- */
+/* system libraries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <termios.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+/* project libraries */
+#include "config.h"
+#include "def.h"
+#include "histogram.h"
+#include "openinterface.h"
+#include "pheromone.h"
+#include "protocol.h"
+#include "rng.h"
+#include "rt.h"
+#include "scheduler.h"
+#include "task.h"
+#include "timelib.h"
+#include "trace.h"
+
+/* -- Defines -- */
+// Default number of measured runs per task and cache state
+#define WCET_BENCH_RUNS			2000
+// Default margin added to the cold maximum for the suggested budget (%)
+#define WCET_BENCH_MARGIN		20
+// Memory written before a cold run, larger than the last-level cache
+#define WCET_BENCH_EVICT_SIZE	(32 * 1024 * 1024)
+// Upper limit of recorded RFID tags and UDP packets
+#define WCET_BENCH_RECORD_MAX	4096
+// Longest recorded UDP packet
+#define WCET_BENCH_PACKET_MAX	1024
+
+/* -- Types -- */
+
+/**
+ * @brief Recorded input lines (RFID tags or UDP packets)
+ */
+typedef struct s_WCET_BENCH_RECORD_STRUCT
+{
+	char *lines[WCET_BENCH_RECORD_MAX]; // Lines without the line end
+	int num; // Number of lines
+	int next; // Line used next (replayed in a loop)
+
+} wcet_bench_record_t;
+
+/* -- Global Variables -- */
+// Task names as used in config.ini sections ("task_<name>"), indexed by task ID
+static const char *wcet_bench_names[s_CONFIG_TASK_NUM + 1] =
+{
+	"nop", "mission", "navigate", "control", "refine", "report", "communicate", "avoid"
+};
+
+static int wcet_bench_oi_fd = -1; // Open Interface pseudo terminal (device side)
+static int wcet_bench_rfid_fd = -1; // RFID pseudo terminal (device side)
+static int wcet_bench_udp_fd = -1; // Socket sending packets to the agent
+static struct sockaddr_in wcet_bench_udp_addr; // Agent's UDP port on the loopback
+
+static unsigned char *wcet_bench_oi_stream = NULL; // Recorded Open Interface replies
+static long wcet_bench_oi_size = 0;
+static long wcet_bench_oi_next = 0;
+static wcet_bench_record_t wcet_bench_tags; // Recorded RFID tags
+static wcet_bench_record_t wcet_bench_packets; // Recorded UDP packets
+
+static pheromone_t *wcet_bench_phs = NULL; // Pheromone map of another robot
+static unsigned char *wcet_bench_evict = NULL; // Memory written to evict the caches
+
+/* -- Functions -- */
+
+/**
+ * Open a pseudo terminal that stands in for a serial device
+ * @param path Filled with the path of the terminal the agent opens
+ * @param size Size of path
+ * @return Device side descriptor, s_ERROR if failed
+ */
+static int wcet_bench_pty(char *path, size_t size)
+{
+	int fd, sd;
+	struct termios tio;
+
+	fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0 || ptsname_r(fd, path, size) != 0)
+		return s_ERROR;
+
+	// Raw from the start, the agent only sets the line options. The terminal
+	// side stays open so the device side never sees a hang-up
+	sd = open(path, O_RDWR | O_NOCTTY);
+	if (sd < 0 || tcgetattr(sd, &tio) < 0)
+		return s_ERROR;
+	cfmakeraw(&tio);
+	tcsetattr(sd, TCSANOW, &tio);
+
+	return fd;
+}
+
+/**
+ * Read a recording into memory
+ * @param path File path
+ * @param size Filled with the file size
+ * @return File contents (with a terminating zero), NULL if failed
+ */
+static char *wcet_bench_read_file(const char *path, long *size)
+{
+	FILE *file;
+	char *data;
+
+	file = fopen(path, "rb");
+	if (file == NULL)
+		return NULL;
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	data = (char *)malloc(*size + 1);
+	if (fread(data, 1, *size, file) != (size_t)*size) {
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+	data[*size] = '\0';
+	fclose(file);
+
+	return data;
+}
+
+/**
+ * Split a text recording into lines
+ * @param record Record to fill
+ * @param path File path
+ * @return s_OK if successful, s_ERROR if the file can not be read
+ */
+static int wcet_bench_read_lines(wcet_bench_record_t *record, const char *path)
+{
+	char *data, *line;
+	long size;
+
+	data = wcet_bench_read_file(path, &size);
+	if (data == NULL)
+		return s_ERROR;
+
+	record->num = 0;
+	record->next = 0;
+	line = data;
+	while (line < data + size && record->num < WCET_BENCH_RECORD_MAX) {
+		record->lines[record->num++] = line;
+		line = strchr(line, '\n');
+		if (line == NULL)
+			break;
+		*line++ = '\0';
+	}
+
+	return s_OK;
+}
+
+/**
+ * Next recorded line, replayed in a loop
+ * @param record Record
+ * @return Line, NULL if nothing was recorded
+ */
+static const char *wcet_bench_next_line(wcet_bench_record_t *record)
+{
+	const char *line;
+
+	if (record->num == 0)
+		return NULL;
+	line = record->lines[record->next];
+	record->next = (record->next + 1) % record->num;
+
+	return line;
+}
+
+/**
+ * Fill a sensor reply from the recording or with synthetic readings:
+ * small moves and turns, a bump now and then
+ * @param data Reply bytes
+ * @param id Sensor packet ID
+ * @param size Reply size
+ * @return Void
+ */
+static void wcet_bench_oi_reply(unsigned char *data, int id, int size)
+{
+	int i, distance, angle, bump;
+
+	if (wcet_bench_oi_size > 0) {
+		for (i = 0; i < size; i++) {
+			data[i] = wcet_bench_oi_stream[wcet_bench_oi_next];
+			wcet_bench_oi_next = (wcet_bench_oi_next + 1) % wcet_bench_oi_size;
+		}
+		return;
+	}
+
+	memset(data, 0, size);
+	distance = rand() % 20;
+	angle = rand() % 11 - 5;
+	bump = (rand() % 20 == 0) ? 1 + rand() % 3 : 0;
+	switch (id) {
+		case s_OI_SENSOR_PACKET_0:
+			data[0] = bump;
+			data[12] = (distance >> 8) & 0xFF;
+			data[13] = distance & 0xFF;
+			data[14] = (angle >> 8) & 0xFF;
+			data[15] = angle & 0xFF;
+			break;
+		case s_OI_SENSOR_PACKET_1:
+			data[0] = bump;
+			break;
+		case s_OI_SENSOR_PACKET_2:
+			data[2] = (distance >> 8) & 0xFF;
+			data[3] = distance & 0xFF;
+			data[4] = (angle >> 8) & 0xFF;
+			data[5] = angle & 0xFF;
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * Open Interface stand-in: answers sensor requests, swallows commands
+ * @param arg Unused
+ * @return Never returns
+ */
+static void *wcet_bench_oi_serve(void *arg)
+{
+	unsigned char buffer[256], reply[s_OI_SENSOR_PACKET_6_SIZE];
+	int n, i, skip = 0, request = s_FALSE, size;
+
+	(void)arg;
+	while ((n = (int)read(wcet_bench_oi_fd, buffer, sizeof(buffer))) > 0) {
+		for (i = 0; i < n; i++) {
+			if (skip > 0) {
+				skip--;
+			}
+			else if (request) {
+				request = s_FALSE;
+				switch (buffer[i]) {
+					case s_OI_SENSOR_PACKET_0: size = s_OI_SENSOR_PACKET_0_SIZE; break;
+					case s_OI_SENSOR_PACKET_1: size = s_OI_SENSOR_PACKET_1_SIZE; break;
+					case s_OI_SENSOR_PACKET_2: size = s_OI_SENSOR_PACKET_2_SIZE; break;
+					case s_OI_SENSOR_PACKET_3: size = s_OI_SENSOR_PACKET_3_SIZE; break;
+					case s_OI_SENSOR_PACKET_4: size = s_OI_SENSOR_PACKET_4_SIZE; break;
+					case s_OI_SENSOR_PACKET_5: size = s_OI_SENSOR_PACKET_5_SIZE; break;
+					case s_OI_SENSOR_PACKET_6: size = s_OI_SENSOR_PACKET_6_SIZE; break;
+					default: size = 0; break;
+				}
+				wcet_bench_oi_reply(reply, buffer[i], size);
+				if (size > 0 && write(wcet_bench_oi_fd, reply, size) < 0)
+					return NULL;
+			}
+			else if (buffer[i] == s_OI_CMD_SENSORS) {
+				request = s_TRUE;
+			}
+			else if (buffer[i] == s_OI_CMD_DRIVE || buffer[i] == s_OI_CMD_DRIVE_DIRECT) {
+				// Velocity and radius (or both wheel velocities)
+				skip = 4;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Put the RFID frame the refine task reads next: a known tag, an unknown
+ * tag (a victim) or nothing
+ * @return Void
+ */
+static void wcet_bench_feed_rfid(void)
+{
+	char frame[16];
+	const char *tag;
+	int i, r;
+
+	tag = wcet_bench_next_line(&wcet_bench_tags);
+	if (tag == NULL) {
+		r = rand() % 10;
+		if (r < 3 && g_envs->tags_num > 0) {
+			tag = g_envs->tags[rand() % g_envs->tags_num].id;
+		}
+		else if (r == 3) {
+			for (i = 0; i < 10; i++)
+				frame[i + 1] = "0123456789ABCDEF"[rand() % 16];
+			frame[11] = '\0';
+			tag = frame + 1;
+		}
+	}
+	if (tag == NULL || strlen(tag) != 10)
+		return;
+
+	// "\n<10 characters>\r"
+	snprintf(frame, sizeof(frame), "\n%s\r", tag);
+	if (write(wcet_bench_rfid_fd, frame, 12) < 0)
+		perror("wcet_bench: RFID");
+}
+
+/**
+ * Send a packet to the agent's socket
+ * @param packet Packet
+ * @param len Packet length
+ * @return Void
+ */
+static void wcet_bench_send(const char *packet, int len)
+{
+	sendto(wcet_bench_udp_fd, packet, len, 0, (struct sockaddr *)&wcet_bench_udp_addr, sizeof(wcet_bench_udp_addr));
+}
+
+/**
+ * Send the packets the communicate task receives next: the next recorded
+ * one, or a GO_AHEAD, robot poses, a victim and the pheromone map sectors
+ * of another robot
+ * @return Void
+ */
+static void wcet_bench_feed_udp(void)
+{
+	char packet[WCET_BENCH_PACKET_MAX];
+	const char *line;
+	pheromone_map_sector_t **phms;
+	robot_t robot;
+	victim_t victim;
+	int len, i, sender;
+
+	line = wcet_bench_next_line(&wcet_bench_packets);
+	if (line != NULL) {
+		wcet_bench_send(line, strlen(line));
+		return;
+	}
+
+	// Another robot of our team
+	sender = g_config.robot_id + 1;
+
+	len = snprintf(packet, sizeof(packet), "%d,0,%d,%c,%d,0,0,0", g_config.robot_id, g_config.robot_team,
+		s_PROTOCOL_TYPE_GO_AHEAD, (int)(timelib_wall_ms() % 60000));
+	wcet_bench_send(packet, len);
+
+	robot.x = rand() % 5000;
+	robot.y = rand() % 5000;
+	robot.a = 0;
+	protocol_encode(packet, &len, 0, sender, g_config.robot_team, s_PROTOCOL_TYPE_DATA, 0, 0, 0,
+		s_DATA_STRUCT_TYPE_ROBOT, &robot);
+	wcet_bench_send(packet, len);
+
+	if (rand() % 10 == 0) {
+		memset(&victim, 0, sizeof(victim));
+		victim.x = rand() % 5000;
+		victim.y = rand() % 5000;
+		strcpy(victim.id, "0123456789");
+		protocol_encode(packet, &len, 0, sender, g_config.robot_team, s_PROTOCOL_TYPE_DATA, 0, 0, 0,
+			s_DATA_STRUCT_TYPE_VICTIM, &victim);
+		wcet_bench_send(packet, len);
+	}
+
+	// The whole map, as a robot sends it in its slot
+	pheromone_put(wcet_bench_phs, rand() % (wcet_bench_phs->x_cells * wcet_bench_phs->width),
+		rand() % (wcet_bench_phs->y_cells * wcet_bench_phs->width));
+	phms = pheromone_map_extract(wcet_bench_phs);
+	for (i = 0; i < wcet_bench_phs->sector_count; i++) {
+		if ((int)sizeof(packet) < phms[i]->size + 64)
+			continue;
+		protocol_encode(packet, &len, 0, sender, g_config.robot_team, s_PROTOCOL_TYPE_DATA, 0, 0, 0,
+			s_DATA_STRUCT_TYPE_PHEROMONE, phms[i]);
+		wcet_bench_send(packet, len);
+	}
+	pheromone_map_destroy(wcet_bench_phs, phms);
+}
+
+/**
+ * Queue the pheromone map sectors of another robot for the navigate task
+ * @return Void
+ */
+static void wcet_bench_feed_pheromones(void)
+{
+	pheromone_map_sector_t **phms;
+	int i;
+
+	pheromone_put(wcet_bench_phs, rand() % (wcet_bench_phs->x_cells * wcet_bench_phs->width),
+		rand() % (wcet_bench_phs->y_cells * wcet_bench_phs->width));
+	phms = pheromone_map_extract(wcet_bench_phs);
+	for (i = 0; i < wcet_bench_phs->sector_count; i++)
+		queue_enqueue(g_queue_navigate, phms[i], s_DATA_STRUCT_TYPE_PHEROMONE);
+	pheromone_map_destroy(wcet_bench_phs, phms);
+}
+
+/**
+ * Prepare the inputs of one run of a task
+ * @param task_id Task ID
+ * @return Void
+ */
+static void wcet_bench_feed(int task_id)
+{
+	switch (task_id) {
+		case s_TASK_NAVIGATE_ID:
+			wcet_bench_feed_pheromones();
+			break;
+		case s_TASK_REFINE_ID:
+			wcet_bench_feed_rfid();
+			break;
+		case s_TASK_COMMUNICATE_ID:
+			wcet_bench_feed_udp();
+			break;
+		default:
+			// Mission and report use what the other tasks left, control
+			// and avoid are answered by the Open Interface stand-in
+			break;
+	}
+}
+
+/**
+ * Evict the caches (and the TLB) by writing a large buffer
+ * @return Void
+ */
+static void wcet_bench_evict_caches(void)
+{
+	size_t i;
+
+	for (i = 0; i < WCET_BENCH_EVICT_SIZE; i += 64)
+		wcet_bench_evict[i]++;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * Run a task and record its execution times
+ * @param task_id Task ID
+ * @param runs Number of measured runs
+ * @param cold Evict the caches before every run
+ * @param h Histogram of execution times (us)
+ * @return Void
+ */
+static void wcet_bench_measure(int task_id, int runs, int cold, histogram_t *h)
+{
+	struct timespec ts_start, ts_end;
+	long long exec_time;
+	int i;
+
+	histogram_reset(h);
+	for (i = 0; i < runs; i++) {
+		wcet_bench_feed(task_id);
+		if (cold)
+			wcet_bench_evict_caches();
+		timelib_clock_gettime(&ts_start);
+		scheduler_exec_task(task_id);
+		timelib_clock_gettime(&ts_end);
+		exec_time = timelib_timespec_diff_us(ts_start, ts_end);
+		histogram_record(h, exec_time > 0 ? (unsigned long long)exec_time : 0);
+	}
+}
+
+/**
+ * Suggested budget: cold maximum plus margin, rounded up to 0.1 ms
+ * @param h Histogram of cold execution times (us)
+ * @param margin Margin (%)
+ * @return Budget (ms)
+ */
+static double wcet_bench_suggest(histogram_t *h, int margin)
+{
+	double budget = ceil(h->max * (100 + margin) / 100.0 / 100.0) / 10.0;
+
+	return budget > 0.1 ? budget : 0.1;
+}
+
+/**
+ * Print usage
+ */
+static void wcet_bench_usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-c config.ini] [-n runs] [-t task] [-m margin] [-s oi.bin] [-r tags.txt] [-u packets.txt]\n", name);
+	fprintf(stderr, "  -c  configuration file (default ./res/config.ini)\n");
+	fprintf(stderr, "  -n  measured runs per task, warm and cold (default %d)\n", WCET_BENCH_RUNS);
+	fprintf(stderr, "  -t  measure only this task, e.g. -t navigate (default all)\n");
+	fprintf(stderr, "  -m  margin over the cold maximum for the suggested budget in %% (default %d)\n", WCET_BENCH_MARGIN);
+	fprintf(stderr, "  -s  recorded Open Interface sensor replies (raw bytes, replayed in a loop)\n");
+	fprintf(stderr, "  -r  recorded RFID tag IDs, one per line, empty for no tag\n");
+	fprintf(stderr, "  -u  recorded UDP packets, one per line\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *config_path = "./res/config.ini";
+	const char *oi_path = NULL, *tags_path = NULL, *packets_path = NULL;
+	int runs = WCET_BENCH_RUNS, margin = WCET_BENCH_MARGIN, only = 0;
+	int opt, task_id, out, null_fd;
+	static histogram_t warm[s_CONFIG_TASK_NUM + 1], cold[s_CONFIG_TASK_NUM + 1];
+	char path[256];
+	pthread_t oi_thread;
+	double suggested;
+
+	while ((opt = getopt(argc, argv, "c:n:t:m:s:r:u:h")) != -1) {
+		switch (opt) {
+			case 'c': config_path = optarg; break;
+			case 'n': runs = atoi(optarg); break;
+			case 'm': margin = atoi(optarg); break;
+			case 's': oi_path = optarg; break;
+			case 'r': tags_path = optarg; break;
+			case 'u': packets_path = optarg; break;
+			case 't':
+				for (only = 1; only <= s_CONFIG_TASK_NUM; only++) {
+					if (strcmp(optarg, wcet_bench_names[only]) == 0)
+						break;
+				}
+				if (only <= s_CONFIG_TASK_NUM)
+					break;
+				fprintf(stderr, "wcet_bench: unknown task '%s'\n", optarg);
+				/* fall through */
+			default:
+				wcet_bench_usage(argv[0]);
+				return 1;
+		}
+	}
+	if (runs <= 0) {
+		wcet_bench_usage(argv[0]);
+		return 1;
+	}
+
+	config_load_file(config_path);
+	// Inputs from rand(), the tasks from their own streams: both replay with the seed
+	srand(g_config.sim_seed);
+	rng_init(g_config.sim_seed);
+
+	// Recordings
+	if (oi_path != NULL && (wcet_bench_oi_stream = (unsigned char *)wcet_bench_read_file(oi_path, &wcet_bench_oi_size)) == NULL) {
+		fprintf(stderr, "wcet_bench: can not read %s\n", oi_path);
+		return 1;
+	}
+	if ((tags_path != NULL && wcet_bench_read_lines(&wcet_bench_tags, tags_path) == s_ERROR)
+		|| (packets_path != NULL && wcet_bench_read_lines(&wcet_bench_packets, packets_path) == s_ERROR)) {
+		fprintf(stderr, "wcet_bench: can not read %s\n", tags_path != NULL ? tags_path : packets_path);
+		return 1;
+	}
+
+	// Serial devices on pseudo terminals, read by the tasks themselves
+	wcet_bench_oi_fd = wcet_bench_pty(g_config.serialport_openinterface_port_path, sizeof(g_config.serialport_openinterface_port_path));
+	wcet_bench_rfid_fd = wcet_bench_pty(path, sizeof(path));
+	if (wcet_bench_oi_fd < 0 || wcet_bench_rfid_fd < 0) {
+		perror("wcet_bench: pseudo terminal");
+		return 1;
+	}
+	strcpy(g_config.serialport_rfid_port_path, path);
+	g_config.reader_enable = s_FALSE;
+	g_config.scheduler_event_loop = s_FALSE;
+	pthread_create(&oi_thread, NULL, wcet_bench_oi_serve, NULL);
+
+	// Packets go to the agent's socket on the loopback
+	wcet_bench_udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+	memset(&wcet_bench_udp_addr, 0, sizeof(wcet_bench_udp_addr));
+	wcet_bench_udp_addr.sin_family = AF_INET;
+	wcet_bench_udp_addr.sin_port = htons(g_config.udp_port);
+	wcet_bench_udp_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	// Same memory and CPU setup as the agent
+	trace_init(0);
+	if (g_config.rt_enable)
+		rt_init(g_config.rt_cpu, g_config.rt_priority);
+	wcet_bench_evict = (unsigned char *)calloc(WCET_BENCH_EVICT_SIZE, 1);
+
+	// The task bodies print to stdout, keep it for the results only
+	fflush(stdout);
+	out = dup(STDOUT_FILENO);
+	null_fd = open("/dev/null", O_WRONLY);
+	dup2(null_fd, STDOUT_FILENO);
+
+	task_init(1);
+	wcet_bench_phs = pheromone_init(g_envs,
+									g_config.pheromone_width,
+									g_config.pheromone_lifetime,
+									g_config.pheromone_pheromone_radius,
+									g_config.pheromone_eval_radius,
+									g_config.pheromone_eval_dist,
+									g_config.pheromone_sector_max_size);
+	for (task_id = 1; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		if (only != 0 && task_id != only)
+			continue;
+		wcet_bench_measure(task_id, runs, s_FALSE, &warm[task_id]);
+		wcet_bench_measure(task_id, runs, s_TRUE, &cold[task_id]);
+	}
+
+	fflush(stdout);
+	dup2(out, STDOUT_FILENO);
+	close(null_fd);
+	close(out);
+
+	// Execution time distribution (us) and budgets (ms)
+	printf("WCET bench: %d runs per task, warm and cold caches (us)\n\n", runs);
+	printf("Task\t\tBudget\tWarm min/p50/p99/max\t\tCold min/p50/p99/max\t\tSuggested\n");
+	for (task_id = 1; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		if (only != 0 && task_id != only)
+			continue;
+		suggested = wcet_bench_suggest(&cold[task_id], margin);
+		printf("%-12s\t%d ms\t%llu/%llu/%llu/%llu\t\t%llu/%llu/%llu/%llu\t\t%.1f ms%s\n",
+			wcet_bench_names[task_id], g_config.tasks[task_id].wcet,
+			warm[task_id].min, histogram_percentile(&warm[task_id], 50),
+			histogram_percentile(&warm[task_id], 99), warm[task_id].max,
+			cold[task_id].min, histogram_percentile(&cold[task_id], 50),
+			histogram_percentile(&cold[task_id], 99), cold[task_id].max,
+			suggested, suggested > g_config.tasks[task_id].wcet ? " (over budget)" : "");
+	}
+
+	// Ready to paste into a schedgen call
+	printf("\nschedgen");
+	for (task_id = 1; task_id <= s_CONFIG_TASK_NUM; task_id++) {
+		if (only != 0 && task_id != only)
+			continue;
+		printf(" -w %s=%.1f", wcet_bench_names[task_id], wcet_bench_suggest(&cold[task_id], margin));
+	}
+	printf("\n");
+
+	return 0;
+}